@@ -46,6 +46,12 @@ class TrackModel extends ChangeNotifier {
   
   // Visualization Data: List of channels, each containing downsampled peaks (0.0 to 1.0)
   List<List<double>> waveformData = [];
+
+  /// Replaces the waveform once more of the track is known (e.g. background decode).
+  void updateWaveform(List<List<double>> data) {
+    waveformData = data;
+    notifyListeners();
+  }
   
   // Format info
   int? sampleRate;
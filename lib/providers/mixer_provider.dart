@@ -5,6 +5,7 @@ import 'package:elongacion_musical/services/settings_service.dart';
 import 'package:elongacion_musical/models/track_model.dart';
 import 'package:elongacion_musical/utils/waveform_utils.dart';
 import 'package:elongacion_musical/models/catalog_model.dart';
+import 'package:native_audio_engine/live_mixer.dart';
 
 class MixerProvider with ChangeNotifier {
   final SettingsService _settingsService;
@@ -109,6 +110,16 @@ class MixerProvider with ChangeNotifier {
     notifyListeners();
   }
 
+  // --- Output Latency ---
+  OutputLatency get outputLatency => _settingsService.outputLatency;
+  DeviceInfo? get deviceInfo => _audioManager.deviceInfo;
+
+  Future<void> setOutputLatency(OutputLatency value) async {
+    await _settingsService.setOutputLatency(value);
+    _audioManager.setOutputLatency(value);
+    notifyListeners();
+  }
+
   // --- SoundTouch Tuning ---
   int get stSequenceMs => _settingsService.stSequenceMs;
   int get stSeekWindowMs => _settingsService.stSeekWindowMs;
@@ -132,6 +143,16 @@ class MixerProvider with ChangeNotifier {
     notifyListeners();
   }
 
+  bool get groupedStretch => _settingsService.groupedStretch;
+
+  Future<void> toggleGroupedStretch() async {
+    final enabled = !groupedStretch;
+    await _settingsService.setGroupedStretch(enabled);
+    _audioManager.setGroupedStretch(enabled);
+    _applyStTuning();
+    notifyListeners();
+  }
+
   void _applyStTuning() {
     _audioManager.updateSoundTouchTuning(
       stSequenceMs,
@@ -171,6 +192,14 @@ class MixerProvider with ChangeNotifier {
       }).toList();
 
       await _audioManager.loadTracks(mappedTracks);
+
+      // Stems keep decoding after they become playable; refresh the
+      // waveforms once they're complete (unless another exercise took over).
+      _audioManager.decodeComplete.then((_) {
+        if (_currentExercise != exercise) return;
+        _invalidateTracksCache();
+        notifyListeners();
+      });
     } catch (e) {
       debugPrint("Error loading exercise in provider: $e");
     } finally {
@@ -94,6 +94,8 @@ class _SettingsScreenState extends State<SettingsScreen> {
                 currentMode: mixer.isOfflineMode ? AudioEngineMode.offline : AudioEngineMode.realtime,
                 onTap: (m) => mixer.setAudioMode(m),
               ),
+              const SizedBox(height: 16),
+              _buildOutputLatency(mixer),
 
               const Divider(color: AppColors.border, height: 32),
 
@@ -111,6 +113,20 @@ class _SettingsScreenState extends State<SettingsScreen> {
                 style: TextStyle(color: AppColors.textSecondary, fontSize: 13),
               ),
               const SizedBox(height: 16),
+              SwitchListTile(
+                title: const Text('Separate Rhythm Section', style: TextStyle(color: AppColors.textPrimary)),
+                subtitle: const Text('Stretches drums and bass apart from the melodic stems, on their own profile. The sliders below then tune the melodic stems only.', style: TextStyle(color: AppColors.textSecondary)),
+                value: mixer.groupedStretch,
+                activeTrackColor: AppColors.primary,
+                inactiveThumbColor: Colors.grey,
+                inactiveTrackColor: AppColors.surface,
+                tileColor: AppColors.surface,
+                shape: RoundedRectangleBorder(borderRadius: BorderRadius.circular(8)),
+                onChanged: (val) {
+                  mixer.toggleGroupedStretch();
+                },
+              ),
+              const SizedBox(height: 16),
               
               Row(
                 mainAxisAlignment: MainAxisAlignment.spaceEvenly,
@@ -175,6 +191,35 @@ class _SettingsScreenState extends State<SettingsScreen> {
     );
   }
 
+  Widget _buildOutputLatency(MixerProvider mixer) {
+    final info = mixer.deviceInfo;
+    final status = info == null
+        ? 'Load an exercise to see what the device negotiated.'
+        : '${info.outputLatency.inMilliseconds} ms (${info.periods} x ${info.periodSizeInFrames} frames @ ${info.sampleRate} Hz)'
+          '${info.underruns > 0 ? ' - ${info.underruns} dropouts, try a safer setting' : ''}';
+
+    return Column(
+      crossAxisAlignment: CrossAxisAlignment.start,
+      children: [
+        const Text('Output Latency', style: TextStyle(color: AppColors.textPrimary, fontWeight: FontWeight.bold)),
+        const SizedBox(height: 4),
+        const Text('Lower is tighter for playing along; raise it if you hear dropouts.', style: TextStyle(color: AppColors.textSecondary, fontSize: 12)),
+        const SizedBox(height: 8),
+        SegmentedButton<OutputLatency>(
+          segments: const [
+            ButtonSegment(value: OutputLatency.lowest, label: Text('Lowest')),
+            ButtonSegment(value: OutputLatency.balanced, label: Text('Balanced')),
+            ButtonSegment(value: OutputLatency.safe, label: Text('Safe')),
+          ],
+          selected: {mixer.outputLatency},
+          onSelectionChanged: (selection) => mixer.setOutputLatency(selection.first),
+        ),
+        const SizedBox(height: 8),
+        Text(status, style: const TextStyle(color: AppColors.textSecondary, fontSize: 12)),
+      ],
+    );
+  }
+
   Widget _buildTuningSlider({
     required String title, 
     required double value, 
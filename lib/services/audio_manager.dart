@@ -1,13 +1,12 @@
 import 'dart:async';
 import 'package:flutter/foundation.dart';
-import 'package:flutter/services.dart' show rootBundle;
 import 'package:just_audio/just_audio.dart';
-import 'package:wav/wav.dart';
 import 'dart:io';
 import 'package:elongacion_musical/models/track_model.dart';
 import 'package:elongacion_musical/services/mixer_stream_source.dart';
 import 'package:elongacion_musical/services/settings_service.dart';
-import 'package:elongacion_musical/utils/wav_parser.dart';
+import 'package:elongacion_musical/utils/mixer_utils.dart';
+import 'package:native_audio_engine/live_mixer.dart';
 
 
 class AudioManager {
@@ -17,11 +16,8 @@ class AudioManager {
   static const Duration kMobileBuffer = Duration(milliseconds: 400);
   static const Duration kMobileRebuffer = Duration(milliseconds: 800);
   static const Duration kDesktopBuffer = Duration(milliseconds: 500); // Standard
-  
-  // Hardware Latency Estimation (Output delay)
-  static const Duration kHardwareLatencyEst = Duration(milliseconds: 100);
 
-  // final SettingsService _settingsService;
+  final SettingsService _settingsService;
   final AudioPlayer _player = AudioPlayer(
     audioLoadConfiguration: () {
       if (kIsWeb) return const AudioLoadConfiguration();
@@ -57,7 +53,7 @@ class AudioManager {
   bool get isDirty => _isDirty;
 
   // Constructor
-  AudioManager(SettingsService settingsService);
+  AudioManager(this._settingsService);
 
   // -- Playback State --
   // We override positionStream to emit our manual polling updates
@@ -86,114 +82,66 @@ class AudioManager {
   // (Handling moved entirely to Tracks, backend manages `anySolo`)
 
   // -- Loading --
-  Future<void> loadTracks(List<Map<String, String>> trackConfigs) async {
+  Future<void> _decodeComplete = Future.value();
+  /// Completes when the stems of the last [loadTracks] have fully decoded.
+  Future<void> get decodeComplete => _decodeComplete;
+
+  /// Decodes the exercise natively (all stems concurrently, see
+  /// `loadMixerTracksNative`). Returns as soon as every track can play; the
+  /// rest decodes in the background until [decodeComplete].
+  /// [onProgress] receives the fraction decoded.
+  Future<void> loadTracks(List<Map<String, String>> trackConfigs, {void Function(double progress)? onProgress}) async {
     try {
       await stop();
       _tracks.clear();
-      
-      // Load WAVs in parallel/sequence
-      // We need to read the files to get PCM data for TrackModel
-      
-      List<TrackModel> loadedTracks = [];
-      
-      for (var config in trackConfigs) {
-        final id = config['id']!;
-        final path = config['path']!; // Absolute path to file
-        final name = config['name'] ?? 'Track';
-        
-        // Read WAV
-        // Note: For large files, this should be in an isolate. 
-        final WavData wavData;
-        if (path.startsWith('assets/')) {
-          final data = await rootBundle.load(path);
-          wavData = await compute(parseWavBytes, data.buffer.asUint8List());
-        } else {
-           // For local files, read bytes then parse in isolate
-           final fileData = await File(path).readAsBytes();
-           wavData = await compute(parseWavBytes, fileData);
-        }
+      _source?.dispose();
+      _source = null;
 
-        final track = TrackModel(
-          id: id,
-          name: name,
-          assetPath: path,
-        );
-        track.samples = wavData.samples;
-        track.waveformData = wavData.waveform;
-        track.sampleRate = wavData.sampleRate;
-        
-        loadedTracks.add(track);
+      final List<TrackModel> requested = [
+        for (var config in trackConfigs)
+          TrackModel(
+            id: config['id']!,
+            name: config['name'] ?? 'Track',
+            assetPath: config['path']!, // Asset key or absolute path to file
+          ),
+      ];
+
+      final outputLatency = _settingsService.outputLatency;
+      final mixer = LiveMixer(profile: deviceProfileFor(outputLatency));
+      mixer.setRenderAhead(renderAheadFor(outputLatency, mixer.sampleRate));
+      final NativeTrackLoad loaded;
+      try {
+        loaded = await loadMixerTracksNative(mixer, requested, onProgress: onProgress);
+      } catch (e) {
+        mixer.dispose();
+        rethrow;
       }
-      
-      _tracks = loadedTracks;
-      
-      
-      // RE-DO optimized loading:
-      // We need a helper that returns (TrackModel, sampleRate, totalSamples).
-      
-      await _initializeMixer();
-      
+
+      _tracks = requested.where((t) => loaded.handles.containsKey(t.id)).toList();
+      _initializeMixer(mixer, loaded);
+      _decodeComplete = loaded.completed;
+
     } catch (e) {
       debugPrint("AudioManager: Error loading tracks: $e");
       throw e;
     }
   }
   
-  // Better load implementation
-  Future<void> _initializeMixer() async {
-      if (_tracks.isEmpty) return;
-      
-      // Scan for max duration and sample rate
-      int maxSamples = 0;
-      int sampleRate = 44100;
-      
-      // Use the highest sample rate found to avoid downsampling quality loss?
-      // Or use the first one?
-      // Ideally all tracks should match. If not, the current simple mixer might drift or pitch-shift mismatched tracks.
-      // But at least we should match the PLAYER to the CONTENT.
-      for (var t in _tracks) {
-          if (t.sampleRate != null && t.sampleRate! > sampleRate) {
-              sampleRate = t.sampleRate!;
-          }
-      }
-      
-      // We actually need the wav info. 
-      // Since we already loaded samples into TrackModel, we might have lost sampleRate.
-      // But usually all tracks in a session match.
-      // Let's assume 44100 if we can't find it, or peek the first file again?
-      // Optimization: The user is likely passing file paths.
-      
-      // Ideally TrackModel should hold format info.
-      // For this immediate fix, let's just peek one file if possible, or use standard.
-      // Or just rely on what we have.
-      
-      // Let's update `loadTracks` to be better in a moment.
-      // For now, let's assume `initializeMixerTracks` handles the data.
-      
-      // Create Source
-      // We need `totalSamples` for the stream.
-      for (var t in _tracks) {
-          if (t.samples != null && t.samples!.isNotEmpty) {
-              int len = t.samples![0].length;
-              if (len > maxSamples) maxSamples = len;
-          }
-      }
-      
-      // Calculate Latency Hint
-      // Current Configured Buffer + Hardware Est
-      Duration latency = const Duration(milliseconds: 200); // Default/Desktop
-      if (Platform.isAndroid || Platform.isIOS) {
-         latency = kMobileBuffer + kHardwareLatencyEst;
-      }
+  void _initializeMixer(LiveMixer mixer, NativeTrackLoad loaded) {
+      // Latency Hint: what the device negotiated (200 ms if there's no output device)
+      final latency = mixer.deviceInfo?.outputLatency ?? const Duration(milliseconds: 200);
       
+      // Tracks are already decoded (and resampled) into the native mixer
       _source = MixerStreamSource(
          _tracks, 
-         maxSamples, 
-         sampleRate,
+         loaded.totalFrames, 
+         mixer.sampleRate,
          getMasterVolume: () => _masterVolume,
          getPosition: () => Duration.zero, // No longer used for sync
          isBuffering: () => false,
          latencyHint: latency, 
+         mixer: mixer,
+         trackHandles: loaded.handles,
       );
       
       // DISCONNECT JUST_AUDIO FROM MIXER
@@ -202,6 +150,7 @@ class AudioManager {
       
       // Update Duration Stream Manually
       _durationController.add(_source!.sourceDuration);
+      _source!.setGroupedStretch(_settingsService.groupedStretch);
   }
   
   
@@ -234,16 +183,31 @@ class AudioManager {
     _positionTimer?.cancel();
     // Poll faster for smoother updates (e.g. 16ms = ~60fps)
     _positionTimer = Timer.periodic(const Duration(milliseconds: 16), (_) {
-       if (_source != null) {
-          final frames = _source!.getAtomicPositionFrames();
-          final sr = _source!.sampleRate;
-          if (sr > 0) {
-             final micros = (frames * 1000000 / sr).round();
-             _positionController.add(Duration(microseconds: micros));
-          }
+       final clock = _pollClock();
+       if (clock != null) {
+          _positionController.add(_framesToDuration(clock.position));
        }
     });
   }
+
+  // Last audible-position clock read from the engine and its age, so
+  // [currentPosition] can interpolate between polls without an FFI call.
+  PlaybackClock? _clock;
+  final Stopwatch _clockAge = Stopwatch();
+
+  PlaybackClock? _pollClock() {
+    _clock = _source?.playbackClock;
+    _clockAge
+      ..reset()
+      ..start();
+    return _clock;
+  }
+
+  Duration _framesToDuration(int frames) {
+    final sr = _source?.sampleRate ?? 0;
+    if (sr <= 0) return Duration.zero;
+    return Duration(microseconds: (frames * 1000000 / sr).round());
+  }
   
   void _stopPositionTimer() {
     _positionTimer?.cancel();
@@ -253,6 +217,7 @@ class AudioManager {
   
   Future<void> seek(Duration position) async {
     _source?.seek(position);
+    _pollClock(); // reports the seek target until its audio reaches the speaker
     _positionController.add(position);
   }
   
@@ -270,6 +235,11 @@ class AudioManager {
       );
   }
   
+  /// Stretch rhythmic stems separately, see [MixerStreamSource.setGroupedStretch].
+  void setGroupedStretch(bool enabled) {
+      _source?.setGroupedStretch(enabled);
+  }
+  
   void setMasterVolume(double vol) {
     _masterVolume = vol;
     _player.setVolume(vol); // Just_audio handling master volume
@@ -282,18 +252,44 @@ class AudioManager {
      _notifyDirty();
   }
   
+  // -- Output Device --
+  static DeviceProfile deviceProfileFor(OutputLatency latency) {
+    switch (latency) {
+      case OutputLatency.lowest:
+        return DeviceProfile.lowestLatency;
+      case OutputLatency.balanced:
+        return DeviceProfile.balanced;
+      case OutputLatency.safe:
+        return DeviceProfile.safe;
+    }
+  }
+
+  /// The safe preset also renders ahead on its own thread (100 ms), trading
+  /// control latency for headroom against slow time-stretch blocks.
+  static int renderAheadFor(OutputLatency latency, int sampleRate) {
+    return latency == OutputLatency.safe ? sampleRate ~/ 10 : 0;
+  }
+
+  /// Negotiated buffers and measured latency of the current output, if any.
+  DeviceInfo? get deviceInfo => _source?.deviceInfo;
+
+  /// Reopens the output of the loaded exercise; later loads pick up the
+  /// setting from [SettingsService.outputLatency].
+  void setOutputLatency(OutputLatency latency) {
+    final source = _source;
+    if (source == null) return;
+    source.setDeviceProfile(deviceProfileFor(latency));
+    source.setRenderAhead(renderAheadFor(latency, source.sampleRate));
+  }
+
   // -- High Precision Polling Getter --
+  /// What is being heard now: compensated for the time-stretch pipeline and
+  /// the output latency. While playing it interpolates the last poll.
   Duration get currentPosition {
-      if (_source != null) {
-          final frames = _source!.getAtomicPositionFrames();
-          // Hardware Latency Compensation would go here
-          // e.g. final latencyFrames = ...
-          final sr = _source!.sampleRate;
-          if (sr > 0) {
-              return Duration(microseconds: (frames * 1000000 / sr).round());
-          }
-      }
-      return Duration.zero;
+      final clock = (_positionTimer != null ? _clock : null) ?? _pollClock();
+      if (clock == null) return Duration.zero;
+      final elapsed = _positionTimer != null ? _clockAge.elapsed : Duration.zero;
+      return _framesToDuration(clock.positionAfter(elapsed));
   }
 
   void setTrackPan(String id, double pan) {
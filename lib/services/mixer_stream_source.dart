@@ -30,12 +30,15 @@ class MixerStreamSource extends StreamAudioSource {
   
   // Latency Control
   final double _targetBufferSeconds = 0.2; 
-  final Duration latencyHint; // NEW: Explicit latency compensation
+  Duration latencyHint; // Output latency of the device (see setDeviceProfile)
   
   double _currentTempo = 1.0;
   
   // Native Mixer
-  final LiveMixer _liveMixer = LiveMixer();
+  final LiveMixer _liveMixer;
+  
+  // Native track handles by TrackModel id (avoids string lookups per control call)
+  Map<String, int> _trackHandles = {};
   
   // Control update flags
   bool _needsTrackUpdate = false; 
@@ -44,13 +47,18 @@ class MixerStreamSource extends StreamAudioSource {
   // Removed AudioProcessor - Native side handles it now directly in liveMixer.process
   // late final AudioProcessor _processor;
 
+  /// Pass [mixer] and [trackHandles] when the tracks were already decoded into
+  /// a native mixer (see `loadMixerTracksNative`); otherwise [tracks] must carry
+  /// PCM samples and are registered here. The source takes ownership of [mixer].
   MixerStreamSource(this.tracks, this.totalSamples, this.sampleRate, {
     required this.getMasterVolume,
     required this.getPosition,
     required this.isBuffering,
     this.latencyHint = const Duration(milliseconds: 200), // Default safe value
-  }) {
-      initializeMixerTracks(_liveMixer, tracks);
+    LiveMixer? mixer,
+    Map<String, int>? trackHandles,
+  }) : _liveMixer = mixer ?? LiveMixer() {
+      _trackHandles = trackHandles ?? initializeMixerTracks(_liveMixer, tracks);
       
       // Initialize Native Speed
       _liveMixer.setSpeed(_currentTempo);
@@ -69,30 +77,82 @@ class MixerStreamSource extends StreamAudioSource {
   static const int SETTING_SEEKWINDOW_MS       = 4;
   static const int SETTING_OVERLAP_MS          = 5;
 
-  void tuneSoundTouch({int? sequenceMs, int? seekWindowMs, int? overlapMs}) {
-      if (sequenceMs != null) _liveMixer.setSoundTouchSetting(SETTING_SEQUENCE_MS, sequenceMs);
-      if (seekWindowMs != null) _liveMixer.setSoundTouchSetting(SETTING_SEEKWINDOW_MS, seekWindowMs);
+  /// Tunes stretch [group], or every group when null. With grouped
+  /// stretching on, untargeted tuning only reaches the melodic group.
+  void tuneSoundTouch({int? sequenceMs, int? seekWindowMs, int? overlapMs, int? group}) {
+      final target = group ?? (_groupedStretch ? melodicGroup : null);
+      void apply(int settingId, int value) {
+        if (target == null) {
+          _liveMixer.setSoundTouchSetting(settingId, value);
+        } else {
+          _liveMixer.setStretchGroupSetting(target, settingId, value);
+        }
+      }
+
+      if (sequenceMs != null) apply(SETTING_SEQUENCE_MS, sequenceMs);
+      if (seekWindowMs != null) apply(SETTING_SEEKWINDOW_MS, seekWindowMs);
       
       // We repurpose overlapMs to set the AA Filter Length instead since Overlap isn't as easily tunable
-      if (overlapMs != null) _liveMixer.setSoundTouchSetting(SETTING_AA_FILTER_LENGTH, overlapMs);
+      if (overlapMs != null) apply(SETTING_AA_FILTER_LENGTH, overlapMs);
       
-      debugPrint("SoundTouch Tuned: Seq=$sequenceMs, Seek=$seekWindowMs, AAFilterTap=$overlapMs");
+      debugPrint("SoundTouch Tuned (group ${target ?? 'all'}): Seq=$sequenceMs, Seek=$seekWindowMs, AAFilterTap=$overlapMs");
   }
 
   // Helper Profiles
-  void applyRhythmicProfile() {
-      tuneSoundTouch(sequenceMs: 40, seekWindowMs: 15, overlapMs: 8);
+  void applyRhythmicProfile({int? group}) {
+      tuneSoundTouch(sequenceMs: 40, seekWindowMs: 15, overlapMs: 8, group: group);
+  }
+
+  void applyMelodicProfile({int? group}) {
+      tuneSoundTouch(sequenceMs: 100, seekWindowMs: 30, overlapMs: 16, group: group);
+  }
+
+  // -- Stretch Groups --
+  // Grouped stretching gives drums/bass their own SoundTouch on the rhythmic
+  // profile; everything else stays in group 0 with the user's tuning.
+  static const int melodicGroup = 0;
+  static const int rhythmicGroup = 1;
+  static final RegExp _rhythmicNames = RegExp(r'drum|bater|perc|bass|bajo|kick|bombo|snare|caja', caseSensitive: false);
+
+  bool _groupedStretch = false;
+  bool get groupedStretch => _groupedStretch;
+
+  static bool isRhythmicTrack(TrackModel track) {
+      return _rhythmicNames.hasMatch(track.name) || _rhythmicNames.hasMatch(track.id);
   }
 
-  void applyMelodicProfile() {
-      tuneSoundTouch(sequenceMs: 100, seekWindowMs: 30, overlapMs: 16);
+  void setGroupedStretch(bool enabled) {
+      if (enabled == _groupedStretch) return;
+      _groupedStretch = enabled;
+      if (enabled) applyRhythmicProfile(group: rhythmicGroup);
+      for (final track in tracks) {
+        final handle = _trackHandles[track.id];
+        if (handle == null) continue;
+        final group = enabled && isRhythmicTrack(track) ? rhythmicGroup : melodicGroup;
+        _liveMixer.setTrackStretchGroup(handle, group);
+      }
   }
   
   // -- Control Pass-throughs --
-  void setVolume(String id, double vol) => _liveMixer.setVolume(id, vol);
-  void setPan(String id, double pan) => _liveMixer.setPan(id, pan);
-  void setMute(String id, bool muted) => _liveMixer.setMute(id, muted);
-  void setSolo(String id, bool solo) => _liveMixer.setSolo(id, solo);
+  void setVolume(String id, double vol) {
+    final handle = _trackHandles[id];
+    if (handle != null) _liveMixer.setTrackVolume(handle, vol);
+  }
+
+  void setPan(String id, double pan) {
+    final handle = _trackHandles[id];
+    if (handle != null) _liveMixer.setTrackPan(handle, pan);
+  }
+
+  void setMute(String id, bool muted) {
+    final handle = _trackHandles[id];
+    if (handle != null) _liveMixer.setTrackMute(handle, muted);
+  }
+
+  void setSolo(String id, bool solo) {
+    final handle = _trackHandles[id];
+    if (handle != null) _liveMixer.setTrackSolo(handle, solo);
+  }
   
   // Loop Control
   // Loop Control State
@@ -133,6 +193,24 @@ class MixerStreamSource extends StreamAudioSource {
   int getAtomicPositionFrames() {
      return _liveMixer.getAtomicPosition();
   }
+
+  /// Audible (latency compensated) position, see [LiveMixer.playbackClock].
+  PlaybackClock? get playbackClock => _liveMixer.playbackClock;
+
+  // --- OUTPUT DEVICE ---
+  DeviceInfo? get deviceInfo => _liveMixer.deviceInfo;
+
+  /// Reopens the output with [profile] and takes [latencyHint] from the new device.
+  bool setDeviceProfile(DeviceProfile profile) {
+     final ok = _liveMixer.setDeviceProfile(profile);
+     final info = _liveMixer.deviceInfo;
+     if (info != null) latencyHint = info.outputLatency;
+     return ok;
+  }
+
+  void setRenderAhead(int frames) {
+     _liveMixer.setRenderAhead(frames);
+  }
   
   void seek(Duration position) {
       if (sampleRate <= 0) return;
@@ -307,14 +385,15 @@ class MixerStreamSource extends StreamAudioSource {
           // --- NATIVE GENERATION ---
           int inputFramesNeeded = 1024; // Smaller chunks for responsiveness
 
-          // Call Native Mixer (returns interleaved stereo)
-          List<double> mixedChunk = _liveMixer.process(inputFramesNeeded);
+          // Call Native Mixer (interleaved stereo PCM16, converted natively).
+          // The view is reused by the next call, so the yielded bytes are a copy.
+          Uint8List pcm = _liveMixer.processPcm16(inputFramesNeeded);
 
           // Update Linear Counter after processing (SoundTouch changes frame count)
-          localTotalFrames += mixedChunk.length ~/ _numChannels; // Should be inputFramesNeeded
+          localTotalFrames += pcm.length ~/ (_numChannels * _bytesPerSample); // Should be inputFramesNeeded
 
-          if (mixedChunk.isNotEmpty) {
-             Uint8List outputBytes = floatToBytes(mixedChunk);
+          if (pcm.isNotEmpty) {
+             Uint8List outputBytes = Uint8List.fromList(pcm);
 
              // Check Bounds if endByte is set
              if (endByte != null) {
@@ -5,8 +5,17 @@ enum AudioEngineMode {
   offline
 }
 
+/// Output buffer size preset, see [DeviceProfile].
+enum OutputLatency {
+  lowest,
+  balanced,
+  safe,
+}
+
 class SettingsService {
   static const String _audioModeKey = 'audio_mode';
+  static const String _outputLatencyKey = 'output_latency';
+  static const String _groupedStretchKey = 'grouped_stretch';
   static const String _showWaveformsKey = 'show_waveforms';
   static const String _lockPortraitKey = 'lock_portrait';
 
@@ -29,6 +38,23 @@ class SettingsService {
     await _prefs.setInt(_audioModeKey, mode.index);
   }
 
+  OutputLatency get outputLatency {
+    final index = _prefs.getInt(_outputLatencyKey);
+    if (index == null || index >= OutputLatency.values.length) return OutputLatency.balanced;
+    return OutputLatency.values[index];
+  }
+
+  Future<void> setOutputLatency(OutputLatency value) async {
+    await _prefs.setInt(_outputLatencyKey, value.index);
+  }
+
+  /// Rhythmic stems time-stretched separately from melodic ones.
+  bool get groupedStretch => _prefs.getBool(_groupedStretchKey) ?? false;
+
+  Future<void> setGroupedStretch(bool value) async {
+    await _prefs.setBool(_groupedStretchKey, value);
+  }
+
   bool get showWaveforms => _prefs.getBool(_showWaveformsKey) ?? true;
 
   Future<void> setShowWaveforms(bool value) async {
@@ -2,60 +2,182 @@ import 'dart:ffi';
 import 'package:elongacion_musical/models/track_model.dart';
 import 'package:native_audio_engine/live_mixer.dart';
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart' show rootBundle;
 import 'package:ffi/ffi.dart';
 
-void initializeMixerTracks(LiveMixer mixer, List<TrackModel> tracks) {
+/// Registers every track with the native mixer.
+/// Returns the native handle of each track id, for the handle-based setters.
+Map<String, int> initializeMixerTracks(LiveMixer mixer, List<TrackModel> tracks) {
     debugPrint("MixerUtils: Initializing Native Mixer with ${tracks.length} tracks (Float32 Optimized)");
+    final Map<String, int> handles = {};
     for (var track in tracks) {
         if (track.samples != null && track.samples!.isNotEmpty) {
            
            int channels = track.samples!.length;
+           int len = track.samples![0].length;
+
+           // ZERO-COPY REGISTRATION:
+           // The mixer allocates the final (aligned, interleaved) buffer and we write
+           // straight into it. No intermediate interleave list, no FFI staging copy.
+           // Audio at another rate is resampled by the engine, which copies anyway.
+           final bool resample = track.sampleRate != null && track.sampleRate != mixer.sampleRate;
+           int handle = resample ? -1 : mixer.createTrack(track.id, len * channels, channels);
+           final Float32List? native = resample ? Float32List(len * channels) : mixer.trackBuffer(handle, len * channels);
            
-           // Direct Float32List handling for MEMORY OPTIMIZATION.
-           // Note: LiveMixerBindings now expects us to handle pointers or TypedLists more efficiently.
-           
-           if (channels == 1) {
-               // MONO: Direct Pass
-               // The samples[0] is already Float32List.
-               mixer.addTrackFloat32(track.id, track.samples![0], 1);
-           } else {
-               // STEREO: Interleave
-               // Unfortunate copy, but necessary for mixing. 
-               // However, we can create a single Float32List for the interleaved data.
-               
-               int len = track.samples![0].length;
-               final interleaved = Float32List(len * 2);
-               
-               for (int i=0; i<len; i++) {
-                   interleaved[i*2] = track.samples![0][i];
-                   interleaved[i*2+1] = track.samples![1][i];
+           if ((resample || handle >= 0) && native != null) {
+               if (channels == 1) {
+                   // MONO: Direct Pass
+                   native.setAll(0, track.samples![0]);
+               } else {
+                   // STEREO: Interleave into the native buffer
+                   final left = track.samples![0];
+                   final right = track.samples![1];
+                   for (int i=0; i<len; i++) {
+                       native[i*2] = left[i];
+                       native[i*2+1] = right[i];
+                   }
+               }
+               if (resample) {
+                   handle = mixer.addTrackFloat32(track.id, native, channels, sampleRate: track.sampleRate!);
+               } else {
+                   mixer.commitTrack(handle);
                }
-               
-               mixer.addTrackFloat32(track.id, interleaved, 2);
            }
            
-           mixer.setVolume(track.id, track.volume);
-           mixer.setPan(track.id, track.pan);
-           mixer.setMute(track.id, track.isMuted);
-           mixer.setSolo(track.id, track.isSolo);
+           if (handle < 0) {
+               debugPrint("MixerUtils: Native mixer rejected track ${track.id}");
+               continue;
+           }
+           handles[track.id] = handle;
+           
+           mixer.setTrackVolume(handle, track.volume);
+           mixer.setTrackPan(handle, track.pan);
+           mixer.setTrackMute(handle, track.isMuted);
+           mixer.setTrackSolo(handle, track.isSolo);
         }
     }
     debugPrint("MixerUtils: Native Tracks Initialized");
+    return handles;
+}
+
+/// Result of [loadMixerTracksNative].
+class NativeTrackLoad {
+  /// Native handle of every track that can play.
+  final Map<String, int> handles;
+  /// Length of the longest track, in frames at the mixer's [LiveMixer.sampleRate].
+  final int totalFrames;
+  /// Completes once every stem has finished decoding in the background and
+  /// the waveforms have been refreshed with the full track.
+  final Future<void> completed;
+
+  NativeTrackLoad(this.handles, this.totalFrames, this.completed);
+}
+
+/// Decodes every track inside the native engine (all stems concurrently) and
+/// fills in waveform / format info on each [TrackModel]. PCM never crosses
+/// into Dart, so [TrackModel.samples] stays null.
+///
+/// Returns as soon as every track can start playing: the rest of each stem
+/// keeps decoding in the background ([NativeTrackLoad.completed]) and the
+/// mixer holds playback at the decoded edge if it ever catches up.
+/// [onProgress] receives the overall fraction decoded (0..1) until the
+/// background decode completes.
+Future<NativeTrackLoad> loadMixerTracksNative(LiveMixer mixer, List<TrackModel> tracks, {void Function(double progress)? onProgress}) async {
+    final Map<String, int> pending = {};
+
+    // Queue all decodes up front; each one starts as soon as it is queued.
+    for (var track in tracks) {
+        final int handle;
+        if (track.assetPath.startsWith('assets/')) {
+            final data = await rootBundle.load(track.assetPath);
+            handle = mixer.addTrackFromBytes(track.id, data.buffer.asUint8List(data.offsetInBytes, data.lengthInBytes));
+        } else {
+            handle = mixer.addTrackFromFile(track.id, track.assetPath);
+        }
+
+        if (handle < 0) {
+            debugPrint("MixerUtils: Native mixer rejected track ${track.id}");
+            continue;
+        }
+        pending[track.id] = handle;
+    }
+
+    // Polls every decode once; true while any status is still [waiting].
+    bool poll(bool Function(TrackLoadStatus status) waiting) {
+        int decoded = 0;
+        int total = 0;
+        bool wait = false;
+        for (final handle in pending.values) {
+            final status = mixer.trackLoadStatus(handle);
+            decoded += status.decodedFrames;
+            total += status.totalFrames;
+            if (waiting(status)) wait = true;
+        }
+        if (total > 0) onProgress?.call((decoded / total).clamp(0.0, 1.0));
+        return wait;
+    }
+
+    // Wait until every track is playable (length known) or has failed
+    while (poll((status) => status.isPending)) {
+        await Future.delayed(const Duration(milliseconds: 16));
+    }
+
+    final Map<String, int> handles = {};
+    final List<TrackModel> loaded = [];
+    int totalFrames = 0;
+    for (var track in tracks) {
+        final handle = pending[track.id];
+        if (handle == null) continue;
+
+        final info = mixer.trackInfo(handle);
+        if (!mixer.trackLoadStatus(handle).isPlayable || info == null) {
+            debugPrint("MixerUtils: Could not decode ${track.assetPath}");
+            mixer.removeTrackHandle(handle);
+            pending.remove(track.id);
+            continue;
+        }
+        handles[track.id] = handle;
+        loaded.add(track);
+        if (info.frames > totalFrames) totalFrames = info.frames;
+
+        track.sampleRate = mixer.sampleRate;
+        _fillWaveform(mixer, track, handle, info, notify: false);
+
+        mixer.setTrackVolume(handle, track.volume);
+        mixer.setTrackPan(handle, track.pan);
+        mixer.setTrackMute(handle, track.isMuted);
+        mixer.setTrackSolo(handle, track.isSolo);
+    }
+
+    // Background phase: the waveforms above only cover what was decoded so far
+    Future<void> finish() async {
+        while (poll((status) => status.isLoading)) {
+            await Future.delayed(const Duration(milliseconds: 50));
+        }
+        for (var track in loaded) {
+            final handle = handles[track.id]!;
+            final info = mixer.trackInfo(handle);
+            if (info != null) _fillWaveform(mixer, track, handle, info, notify: true);
+        }
+        onProgress?.call(1.0);
+        debugPrint("MixerUtils: Native decode finished, ${handles.length}/${tracks.length} tracks");
+    }
+
+    debugPrint("MixerUtils: ${handles.length}/${tracks.length} tracks playable, decoding the rest in the background");
+    return NativeTrackLoad(handles, totalFrames, finish());
 }
 
-/// Helper to convert Float List back to ByteData (16-bit PCM)
-Uint8List floatToBytes(List<double> samples) {
-  final buffer = Uint8List(samples.length * 2);
-  final view = ByteData.view(buffer.buffer);
-  
-  for (int i = 0; i < samples.length; i++) {
-      double s = samples[i];
-      if (s > 1.0) s = 1.0;
-      if (s < -1.0) s = -1.0;
-      
-      int pcm = (s * 32767).toInt();
-      view.setInt16(i * 2, pcm, Endian.little);
-  }
-  
-  return buffer;
+void _fillWaveform(LiveMixer mixer, TrackModel track, int handle, ({int frames, int channels}) info, {required bool notify}) {
+    // Same density as parseWavBytes: ~150 peaks per second
+    final seconds = info.frames / mixer.sampleRate;
+    final points = (seconds * 150).toInt().clamp(2000, 100000);
+    final data = [
+        for (int c = 0; c < info.channels; c++)
+            mixer.trackPeaks(handle, c, points)?.toList() ?? <double>[],
+    ];
+    if (notify) {
+        track.updateWaveform(data);
+    } else {
+        track.waveformData = data;
+    }
 }
@@ -3,24 +3,247 @@ import 'dart:typed_data';
 import 'package:ffi/ffi.dart';
 import 'live_mixer_bindings.dart';
 
+/// In-memory sample format of a track. Must match `TrackCodec` in track_storage.h.
+enum TrackCodec {
+  float32,
+  /// 16-bit PCM, half the memory of float32.
+  int16,
+  /// Lossless 16-bit block codec, typically 3-5x smaller on quiet stems.
+  lossless,
+}
+
+/// Decode status of a track added with [LiveMixer.addTrackFromFile] or
+/// [LiveMixer.addTrackFromBytes].
+class TrackLoadStatus {
+  static const int failed = -1;
+  static const int loading = 0;
+  static const int ready = 1;
+  /// Length is known and the track already plays up to [decodedFrames].
+  static const int streaming = 2;
+
+  final int state;
+  final int decodedFrames;
+  /// 0 while the decoder can't tell the length up front.
+  final int totalFrames;
+
+  const TrackLoadStatus(this.state, this.decodedFrames, this.totalFrames);
+
+  /// Still decoding, whether or not it can already play.
+  bool get isLoading => state == loading || state == streaming;
+  /// Not playable yet.
+  bool get isPending => state == loading;
+  bool get isPlayable => state == ready || state == streaming;
+  bool get isReady => state == ready;
+  bool get isFailed => state == failed;
+}
+
+/// Time-stretch engine of a [LiveMixer]. Indices match `StretchEngine` in
+/// time_stretcher.h.
+enum StretchEngine {
+  /// SoundTouch WSOLA (default), tunable with [LiveMixer.setSoundTouchSetting].
+  soundTouch,
+  /// Phase vocoder: smoother on sustained material, softer transients.
+  vocoder,
+  /// No stretching: plays at 1x whatever the speed.
+  bypass,
+}
+
+/// Sample format of an exported WAV. Indices match `WavSampleFormat` in wav_writer.h.
+enum RenderFormat {
+  pcm16,
+  pcm24,
+  float32,
+}
+
+/// Progress of an export started with [LiveMixer.renderToFile].
+class RenderStatus {
+  static const int failed = -1;
+  static const int running = 0;
+  static const int done = 1;
+  static const int cancelled = 2;
+
+  final int state;
+  /// Output frames (at the mixer rate, after stretching) written so far.
+  final int framesWritten;
+  final int totalFrames;
+
+  const RenderStatus(this.state, this.framesWritten, this.totalFrames);
+
+  double get progress => totalFrames > 0 ? framesWritten / totalFrames : 0.0;
+  bool get isRunning => state == running;
+  bool get isDone => state == done;
+  bool get isFailed => state == failed;
+  bool get isCancelled => state == cancelled;
+}
+
+/// Audio backend preference. Indices match `DeviceBackend` in live_mixer.h.
+enum AudioBackend {
+  /// Platform default order.
+  auto,
+  aaudio,
+  openSL,
+  pulseAudio,
+  alsa,
+  wasapi,
+  /// No output; the engine runs on a timer (tests, headless rendering).
+  nullDevice,
+}
+
+/// Output device request. Zero sizes let the backend choose; a backend or
+/// exclusive mode the system can't provide falls back to the default.
+class DeviceProfile {
+  /// Takes precedence over [periodSizeInMilliseconds] when non-zero.
+  final int periodSizeInFrames;
+  final int periodSizeInMilliseconds;
+  final int periods;
+  /// Low-latency performance profile (AAudio/WASAPI fast paths) vs conservative.
+  final bool lowLatency;
+  final bool exclusive;
+  final AudioBackend backend;
+
+  const DeviceProfile({
+    this.periodSizeInFrames = 0,
+    this.periodSizeInMilliseconds = 20,
+    this.periods = 3,
+    this.lowLatency = true,
+    this.exclusive = false,
+    this.backend = AudioBackend.auto,
+  });
+
+  /// Small exclusive buffers for play-along on devices that can sustain them.
+  static const lowestLatency = DeviceProfile(periodSizeInMilliseconds: 5, periods: 2, exclusive: true);
+  /// The engine's long-standing default: 20 ms x 3.
+  static const balanced = DeviceProfile();
+  /// Large buffers for devices that underrun with [balanced].
+  static const safe = DeviceProfile(periodSizeInMilliseconds: 40, periods: 4, lowLatency: false);
+
+  DeviceProfileFields get _fields => (
+        periodSizeInFrames: periodSizeInFrames,
+        periodSizeInMilliseconds: periodSizeInMilliseconds,
+        periods: periods,
+        lowLatency: lowLatency,
+        exclusive: exclusive,
+        backend: backend.index,
+      );
+}
+
+/// What the output device actually negotiated, plus what the engine has
+/// measured since the device was (re)opened.
+class DeviceInfo {
+  final AudioBackend backend;
+  final int sampleRate;
+  final int periodSizeInFrames;
+  final int periods;
+  final bool exclusive;
+  /// Largest block the device has pulled so far (0 until it has run).
+  final int maxCallbackFrames;
+  /// Frames between the mixer and the speaker.
+  final int outputLatencyFrames;
+  /// Gaps between callbacks longer than the device buffer, i.e. dropouts.
+  final int underruns;
+
+  DeviceInfo._(DeviceInfoFields f)
+      : backend = f.backend < AudioBackend.values.length ? AudioBackend.values[f.backend] : AudioBackend.auto,
+        sampleRate = f.sampleRate,
+        periodSizeInFrames = f.periodSizeInFrames,
+        periods = f.periods,
+        exclusive = f.exclusive,
+        maxCallbackFrames = f.maxCallbackFrames,
+        outputLatencyFrames = f.outputLatencyFrames,
+        underruns = f.underruns;
+
+  Duration get outputLatency => Duration(microseconds: outputLatencyFrames * 1000000 ~/ sampleRate);
+}
+
+/// Latency-compensated playback position, see [LiveMixer.playbackClock].
+class PlaybackClock {
+  /// Source frame reaching the speaker at [timestampNanos].
+  final int position;
+  /// Monotonic (steady) clock of the native side.
+  final int timestampNanos;
+  /// Source frames per second of wall time; 0 while paused or stalled.
+  final double framesPerSecond;
+  final int loopStart;
+  /// 0 when looping is off.
+  final int loopEnd;
+
+  PlaybackClock._(PlaybackClockFields f)
+      : position = f.position,
+        timestampNanos = f.timestampNanos,
+        framesPerSecond = f.framesPerSecond,
+        loopStart = f.loopStart,
+        loopEnd = f.loopEnd;
+
+  /// Position [elapsed] after this clock was read, so the UI can animate
+  /// between polls without calling into the engine.
+  int positionAfter(Duration elapsed) {
+    var frames = position + (elapsed.inMicroseconds * framesPerSecond / 1000000).round();
+    if (loopEnd > loopStart && frames >= loopEnd) {
+      frames = loopStart + (frames - loopStart) % (loopEnd - loopStart);
+    }
+    return frames;
+  }
+}
+
 class LiveMixer {
   final LiveMixerBindings _bindings = LiveMixerBindings();
   late Pointer<Void> _handle;
   bool _isDisposed = false;
 
-  LiveMixer() {
-    _handle = _bindings.create();
+  // Native output buffers behind processView / processPcm16, grown on demand
+  Pointer<Float> _floatOut = nullptr;
+  int _floatOutFrames = 0;
+  Pointer<Int16> _pcmOut = nullptr;
+  int _pcmOutFrames = 0;
+
+  /// Output rate of the native engine: the audio device's native rate.
+  /// Positions, loop points and track lengths are frames at this rate; tracks
+  /// at other rates are resampled once when they are added.
+  late final int sampleRate;
+
+  /// Opens the output device with [profile]; see [setDeviceProfile] to change it later.
+  LiveMixer({DeviceProfile profile = DeviceProfile.balanced}) {
+    _handle = _bindings.createWithProfile(profile._fields);
+    sampleRate = _bindings.getSampleRate(_handle);
+  }
+
+  /// Reopens the output device, e.g. to step latency down until [DeviceInfo.underruns]
+  /// start to climb. [sampleRate] stays the same; playback continues if running.
+  bool setDeviceProfile(DeviceProfile profile) {
+    if (_isDisposed) return false;
+    return _bindings.setDeviceProfile(_handle, profile._fields);
+  }
+
+  /// Renders up to [frames] ahead of the device on a dedicated high-priority
+  /// thread, so stretch spikes are absorbed instead of underrunning. Fader and
+  /// tempo changes land that much later; seeks stay immediate. 0 (default)
+  /// renders inside the device callback.
+  void setRenderAhead(int frames) {
+    if (_isDisposed) return;
+    _bindings.setRenderAhead(_handle, frames);
+  }
+
+  /// Negotiated buffer sizes and measured latency, or null without an output device.
+  DeviceInfo? get deviceInfo {
+    if (_isDisposed) return null;
+    final fields = _bindings.getDeviceInfo(_handle);
+    return fields == null ? null : DeviceInfo._(fields);
   }
 
   void dispose() {
     if (!_isDisposed) {
       _bindings.destroy(_handle);
+      if (_floatOut != nullptr) malloc.free(_floatOut);
+      if (_pcmOut != nullptr) malloc.free(_pcmOut);
+      _floatOut = nullptr;
+      _pcmOut = nullptr;
       _isDisposed = true;
     }
   }
 
-  void addTrack(String id, List<double> data, int channels) {
-    if (_isDisposed) return;
+  /// Returns a stable track handle for the handle-based setters (-1 on failure).
+  int addTrack(String id, List<double> data, int channels) {
+    if (_isDisposed) return -1;
     
     // We need to pass data as float array.
     // The bindings handle the conversion and copying.
@@ -28,12 +251,103 @@ class LiveMixer {
     // But for now, simple implementation via bindings.
     
     // Optimization: If bindings take List<double> they iterate and copy. That's fine.
-    _bindings.addTrack(_handle, id, data, channels);
+    return _bindings.addTrack(_handle, id, data, channels);
   }
 
-  void addTrackFloat32(String id, Float32List data, int channels) {
-    if (_isDisposed) return;
-    _bindings.addTrackFloat32(_handle, id, data, channels);
+  /// Returns a stable track handle for the handle-based setters (-1 on failure).
+  /// Pass the [sampleRate] of [data] if it may differ from [LiveMixer.sampleRate].
+  int addTrackFloat32(String id, Float32List data, int channels, {int sampleRate = 0}) {
+    if (_isDisposed) return -1;
+    return _bindings.addTrackFloat32(_handle, id, data, channels, sampleRate: sampleRate);
+  }
+
+  // --- ZERO-COPY REGISTRATION ---
+
+  /// Allocates a native track buffer of [numSamples] interleaved floats at
+  /// [sampleRate]. Fill it through [trackBuffer], then call [commitTrack] to
+  /// make it audible.
+  int createTrack(String id, int numSamples, int channels) {
+    if (_isDisposed) return -1;
+    return _bindings.createTrack(_handle, id, numSamples, channels);
+  }
+
+  /// View onto the native buffer of an uncommitted track (no copy).
+  /// Only valid until [commitTrack]; returns null afterwards.
+  Float32List? trackBuffer(int track, int numSamples) {
+    if (_isDisposed) return null;
+    final ptr = _bindings.getTrackBuffer(_handle, track);
+    if (ptr == nullptr) return null;
+    return ptr.asTypedList(numSamples);
+  }
+
+  bool commitTrack(int track) {
+    if (_isDisposed) return false;
+    return _bindings.commitTrack(_handle, track);
+  }
+
+  /// Hands a `malloc`-allocated buffer over to the mixer without copying.
+  /// On success the mixer owns [data] and frees it when the track goes away.
+  int adoptTrack(String id, Pointer<Float> data, int numSamples, int channels) {
+    if (_isDisposed) return -1;
+    return _bindings.adoptTrack(_handle, id, data, numSamples, channels);
+  }
+
+  /// Plays a track straight from a file on disk via a memory map, so long
+  /// exercises don't need to be held in RAM. [path] must be a 32-bit float WAV,
+  /// or a headerless float file in which case [channels] is required (and the
+  /// samples must already be at [sampleRate]).
+  int mapTrackFile(String id, String path, {int channels = 0}) {
+    if (_isDisposed) return -1;
+    return _bindings.mapTrackFile(_handle, id, path, channels);
+  }
+
+  /// Like [addTrackFloat32], but keeps the samples compressed in native memory
+  /// and decodes them around the playhead while mixing.
+  int addCompressedTrack(String id, Float32List data, int channels, TrackCodec codec, {int sampleRate = 0}) {
+    if (_isDisposed) return -1;
+    return _bindings.addCompressedTrack(_handle, id, data, channels, codec.index, sampleRate);
+  }
+
+  // --- NATIVE DECODING ---
+
+  /// Decodes a WAV / FLAC / MP3 file on the engine's loader threads, straight
+  /// into the track buffer. Returns the handle immediately; the track plays
+  /// once [trackLoadStatus] reports ready.
+  int addTrackFromFile(String id, String path) {
+    if (_isDisposed) return -1;
+    return _bindings.addTrackFromFile(_handle, id, path);
+  }
+
+  /// Same as [addTrackFromFile] for an encoded file already in memory
+  /// (e.g. from `rootBundle`).
+  int addTrackFromBytes(String id, Uint8List encoded) {
+    if (_isDisposed) return -1;
+    return _bindings.addTrackFromMemory(_handle, id, encoded);
+  }
+
+  TrackLoadStatus trackLoadStatus(int track) {
+    if (_isDisposed) return const TrackLoadStatus(TrackLoadStatus.failed, 0, 0);
+    final (state, decoded, total) = _bindings.getTrackLoadState(_handle, track);
+    return TrackLoadStatus(state, decoded, total);
+  }
+
+  /// Length and channel count of a track with audio, null otherwise.
+  ({int frames, int channels})? trackInfo(int track) {
+    if (_isDisposed) return null;
+    final info = _bindings.getTrackInfo(_handle, track);
+    if (info == null) return null;
+    return (frames: info.$1, channels: info.$2);
+  }
+
+  /// [points] peak magnitudes (0..1) of one channel, for waveform display.
+  Float32List? trackPeaks(int track, int channel, int points) {
+    if (_isDisposed) return null;
+    return _bindings.getTrackPeaks(_handle, track, channel, points);
+  }
+
+  int getTrackHandle(String id) {
+    if (_isDisposed) return -1;
+    return _bindings.getTrackHandle(_handle, id);
   }
 
   void removeTrack(String id) {
@@ -61,6 +375,32 @@ class LiveMixer {
     _bindings.setSolo(_handle, id, solo);
   }
 
+  // --- HANDLE-BASED CONTROLS (preferred for realtime UI) ---
+  void removeTrackHandle(int track) {
+    if (_isDisposed) return;
+    _bindings.removeTrackHandle(_handle, track);
+  }
+
+  void setTrackVolume(int track, double volume) {
+    if (_isDisposed) return;
+    _bindings.setTrackVolume(_handle, track, volume);
+  }
+
+  void setTrackPan(int track, double pan) {
+    if (_isDisposed) return;
+    _bindings.setTrackPan(_handle, track, pan);
+  }
+
+  void setTrackMute(int track, bool muted) {
+    if (_isDisposed) return;
+    _bindings.setTrackMute(_handle, track, muted);
+  }
+
+  void setTrackSolo(int track, bool solo) {
+    if (_isDisposed) return;
+    _bindings.setTrackSolo(_handle, track, solo);
+  }
+
   void setLoop(int startSample, int endSample, bool enabled) {
     if (_isDisposed) return;
     _bindings.setLoop(_handle, startSample, endSample, enabled);
@@ -80,23 +420,40 @@ class LiveMixer {
   /// [frames] is number of stereo frames to request.
   /// Returns a List<double> of interleaved samples (length = frames * 2).
   List<double> process(int frames) {
-      if (_isDisposed) return List.filled(frames * 2, 0.0);
-      
-      final outputPtr = calloc<Float>(frames * 2);
-      
-      int filled = _bindings.process(_handle, outputPtr, frames);
-      
-      List<double> result = List<double>.filled(frames * 2, 0.0);
-      for (int i = 0; i < frames * 2; i++) {
-          result[i] = outputPtr[i];
+      if (_isDisposed) return Float32List(frames * 2);
+      return Float32List.fromList(processView(frames));
+  }
+
+  /// [process] without the copy: a view of a native buffer owned by the mixer.
+  /// Overwritten by the next call and invalid after [dispose].
+  ///
+  /// Pulling and device output exclude each other: while [startPlayback] has
+  /// the device (or render-ahead) rendering, this returns no frames.
+  Float32List processView(int frames) {
+      if (_isDisposed) return Float32List(frames * 2);
+      if (frames > _floatOutFrames) {
+        if (_floatOut != nullptr) malloc.free(_floatOut);
+        _floatOut = malloc<Float>(frames * 2);
+        _floatOutFrames = frames;
       }
-      
-      calloc.free(outputPtr);
-      return result;
+      int filled = _bindings.process(_handle, _floatOut, frames);
+      return _floatOut.asTypedList(filled * 2);
+  }
+
+  /// Interleaved 16-bit little-endian PCM, ready to stream as WAV data.
+  /// Clamping, conversion and (with [dither]) TPDF dither run natively. Same
+  /// lifetime as [processView]: copy the bytes to keep them past the next call.
+  /// Likewise empty while the device is rendering.
+  Uint8List processPcm16(int frames, {bool dither = true}) {
+      if (_isDisposed) return Uint8List(frames * 4);
+      if (frames > _pcmOutFrames) {
+        if (_pcmOut != nullptr) malloc.free(_pcmOut);
+        _pcmOut = malloc<Int16>(frames * 2);
+        _pcmOutFrames = frames;
+      }
+      int filled = _bindings.processInt16(_handle, _pcmOut, frames, dither);
+      return _pcmOut.cast<Uint8>().asTypedList(filled * 4);
   }
-  
-  // Method to allow filling an existing buffer if we want to avoid allocation thrashing?
-  // Current Stream implementation in Dart usually yields new lists anyway.
   
   // --- NATIVE OUTPUT CONTROL ---
   void startPlayback() {
@@ -109,18 +466,137 @@ class LiveMixer {
      _bindings.stop(_handle);
   }
   
+  /// Last source frame mixed. It runs ahead of what is audible by the
+  /// time-stretch pipeline and the device buffer; see [playbackClock].
   int getAtomicPosition() {
      if (_isDisposed) return 0;
      return _bindings.getAtomicPosition(_handle);
   }
+
+  /// The source frame being heard now (stretcher and output latency
+  /// compensated), with its rate for interpolation between polls.
+  PlaybackClock? get playbackClock {
+     if (_isDisposed) return null;
+     final fields = _bindings.getPlaybackClock(_handle);
+     return fields == null ? null : PlaybackClock._(fields);
+  }
+
+  /// True while playback is held back waiting for a stem to decode further.
+  bool isStalled() {
+     if (_isDisposed) return false;
+     return _bindings.isStalled(_handle);
+  }
   
   void setSpeed(double speed) {
      if (_isDisposed) return;
      _bindings.setSpeed(_handle, speed);
   }
   
+  /// Applies to every stretch group.
   void setSoundTouchSetting(int settingId, int value) {
      if (_isDisposed) return;
      _bindings.setSoundTouchSetting(_handle, settingId, value);
   }
+
+  /// Switches the time-stretch engine, also while playing: the new one is
+  /// warmed up on what is being heard and crossfaded in. Exports and the
+  /// caches follow it.
+  void setStretchEngine(StretchEngine engine) {
+     if (_isDisposed) return;
+     _bindings.setStretchEngine(_handle, engine.index);
+  }
+
+  StretchEngine get stretchEngine {
+     if (_isDisposed) return StretchEngine.soundTouch;
+     return StretchEngine.values[_bindings.getStretchEngine(_handle)];
+  }
+
+  /// Analysis frame of the [StretchEngine.vocoder] engine in every stretch
+  /// group: [fftSize] frames (a power of two, 256 .. 16384) analysed
+  /// [overlap] times over. Short frames keep drums tight, long ones keep
+  /// sustained notes smooth (e.g. 1024 and 4096 at 44.1 kHz).
+  void setVocoderFrame(int fftSize, {int overlap = 4}) {
+     if (_isDisposed) return;
+     _bindings.setVocoderFrame(_handle, fftSize, overlap);
+  }
+
+  /// Number of stretch groups the engine supports.
+  static const int maxStretchGroups = 4;
+
+  /// Moves [track] to its own stretcher [group] (0 .. [maxStretchGroups] - 1).
+  /// Groups are stretched in parallel and mixed afterwards, so each can use
+  /// settings that suit its material (see [setStretchGroupSetting]).
+  bool setTrackStretchGroup(int track, int group) {
+     if (_isDisposed) return false;
+     return _bindings.setTrackStretchGroup(_handle, track, group);
+  }
+
+  /// Like [setSoundTouchSetting], for one stretch group only.
+  void setStretchGroupSetting(int group, int settingId, int value) {
+     if (_isDisposed) return;
+     _bindings.setStretchGroupSetting(_handle, group, settingId, value);
+  }
+
+  /// Like [setVocoderFrame], for one stretch group only.
+  void setStretchGroupVocoderFrame(int group, int fftSize, {int overlap = 4}) {
+     if (_isDisposed) return;
+     _bindings.setStretchGroupVocoderFrame(_handle, group, fftSize, overlap);
+  }
+
+  /// While a loop is active and the mix stays unchanged, the engine renders
+  /// one stretched pass of the loop in the background and replays it instead
+  /// of stretching live. On by default.
+  void setLoopCacheEnabled(bool enabled) {
+     if (_isDisposed) return;
+     _bindings.setLoopCacheEnabled(_handle, enabled);
+  }
+
+  /// True while output comes from the rendered-loop cache.
+  bool get isPlayingFromLoopCache {
+     if (_isDisposed) return false;
+     return _bindings.isPlayingFromLoopCache(_handle);
+  }
+
+  /// Default memory the engine may spend on pre-stretched stems.
+  static const int defaultPreStretchBudget = 128 << 20;
+
+  /// At a tempo other than 1x the engine stretches every stem on its own in
+  /// the background, up to [bytes] of audio (the whole song if it fits), and
+  /// plays by mixing those wherever they cover the playhead. Faders, mute and
+  /// solo then cost nothing. 0 turns it off.
+  void setPreStretchBudget(int bytes) {
+     if (_isDisposed) return;
+     _bindings.setPreStretchBudget(_handle, bytes);
+  }
+
+  /// True while output is mixed from pre-stretched stems.
+  bool get isPlayingPreStretched {
+     if (_isDisposed) return false;
+     return _bindings.isPlayingPreStretched(_handle);
+  }
+
+  // --- OFFLINE EXPORT ---
+
+  /// Renders source frames [startFrame, endFrame) of the current mix (gains,
+  /// tempo, stretch groups) to a WAV file at [sampleRate] on a native thread,
+  /// much faster than real time and without the output device. [endFrame] 0
+  /// means the end of the song. Returns a job id for [renderStatus] and
+  /// [cancelRender], or -1 (a track still decoding or compressed, empty
+  /// range, file not writable).
+  int renderToFile(String path, {RenderFormat format = RenderFormat.pcm16, int startFrame = 0, int endFrame = 0}) {
+     if (_isDisposed) return -1;
+     return _bindings.renderToFile(_handle, path, format.index, startFrame, endFrame);
+  }
+
+  RenderStatus renderStatus(int job) {
+     if (_isDisposed) return const RenderStatus(RenderStatus.failed, 0, 0);
+     final (state, written, total) = _bindings.getRenderState(_handle, job);
+     return RenderStatus(state, written, total);
+  }
+
+  /// Stops an export and deletes its partial file.
+  void cancelRender(int job) {
+     if (_isDisposed) return;
+     _bindings.cancelRender(_handle, job);
+  }
 }
@@ -10,8 +10,13 @@ typedef LiveMixerCreateDart = Pointer<Void> Function();
 typedef LiveMixerDestroyC = Void Function(Pointer<Void>);
 typedef LiveMixerDestroyDart = void Function(Pointer<Void>);
 
-typedef LiveMixerAddTrackC = Void Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, Int32, Int32);
-typedef LiveMixerAddTrackDart = void Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, int, int);
+typedef LiveMixerAddTrackC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, Int32, Int32);
+typedef LiveMixerAddTrackDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, int, int);
+typedef LiveMixerAddTrackAtRateC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, Int32, Int32, Int32);
+typedef LiveMixerAddTrackAtRateDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, int, int, int);
+
+typedef LiveMixerGetTrackHandleC = Int32 Function(Pointer<Void>, Pointer<Utf8>);
+typedef LiveMixerGetTrackHandleDart = int Function(Pointer<Void>, Pointer<Utf8>);
 
 typedef LiveMixerRemoveTrackC = Void Function(Pointer<Void>, Pointer<Utf8>);
 typedef LiveMixerRemoveTrackDart = void Function(Pointer<Void>, Pointer<Utf8>);
@@ -28,6 +33,60 @@ typedef LiveMixerSetMuteDart = void Function(Pointer<Void>, Pointer<Utf8>, bool)
 typedef LiveMixerSetSoloC = Void Function(Pointer<Void>, Pointer<Utf8>, Bool);
 typedef LiveMixerSetSoloDart = void Function(Pointer<Void>, Pointer<Utf8>, bool);
 
+// Zero-copy track registration
+typedef LiveMixerCreateTrackC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Int64, Int32);
+typedef LiveMixerCreateTrackDart = int Function(Pointer<Void>, Pointer<Utf8>, int, int);
+
+typedef LiveMixerGetTrackBufferC = Pointer<Float> Function(Pointer<Void>, Int32);
+typedef LiveMixerGetTrackBufferDart = Pointer<Float> Function(Pointer<Void>, int);
+
+typedef LiveMixerCommitTrackC = Bool Function(Pointer<Void>, Int32);
+typedef LiveMixerCommitTrackDart = bool Function(Pointer<Void>, int);
+
+typedef TrackReleaseC = Void Function(Pointer<Void>);
+typedef LiveMixerAdoptTrackC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, Int64, Int32, Pointer<NativeFunction<TrackReleaseC>>, Pointer<Void>);
+typedef LiveMixerAdoptTrackDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, int, int, Pointer<NativeFunction<TrackReleaseC>>, Pointer<Void>);
+
+typedef LiveMixerMapTrackFileC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, Int32);
+typedef LiveMixerMapTrackFileDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, int);
+
+typedef LiveMixerAddCompressedTrackC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, Int64, Int32, Int32, Int32);
+typedef LiveMixerAddCompressedTrackDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Float>, int, int, int, int);
+
+// Native file decoding
+typedef TrackLoadProgressC = Void Function(Pointer<Void>, Int32, Int64, Int64);
+typedef LiveMixerAddTrackFromFileC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, Pointer<NativeFunction<TrackLoadProgressC>>, Pointer<Void>);
+typedef LiveMixerAddTrackFromFileDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Utf8>, Pointer<NativeFunction<TrackLoadProgressC>>, Pointer<Void>);
+
+typedef LiveMixerAddTrackFromMemoryC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Pointer<Uint8>, Int64, Pointer<NativeFunction<TrackReleaseC>>, Pointer<Void>, Pointer<NativeFunction<TrackLoadProgressC>>, Pointer<Void>);
+typedef LiveMixerAddTrackFromMemoryDart = int Function(Pointer<Void>, Pointer<Utf8>, Pointer<Uint8>, int, Pointer<NativeFunction<TrackReleaseC>>, Pointer<Void>, Pointer<NativeFunction<TrackLoadProgressC>>, Pointer<Void>);
+
+typedef LiveMixerGetTrackLoadStateC = Int32 Function(Pointer<Void>, Int32, Pointer<Int64>, Pointer<Int64>);
+typedef LiveMixerGetTrackLoadStateDart = int Function(Pointer<Void>, int, Pointer<Int64>, Pointer<Int64>);
+
+typedef LiveMixerGetTrackInfoC = Bool Function(Pointer<Void>, Int32, Pointer<Int64>, Pointer<Int32>);
+typedef LiveMixerGetTrackInfoDart = bool Function(Pointer<Void>, int, Pointer<Int64>, Pointer<Int32>);
+
+typedef LiveMixerGetTrackPeaksC = Int32 Function(Pointer<Void>, Int32, Int32, Pointer<Float>, Int32);
+typedef LiveMixerGetTrackPeaksDart = int Function(Pointer<Void>, int, int, Pointer<Float>, int);
+
+// Offline export
+typedef RenderProgressC = Void Function(Pointer<Void>, Int32, Int64, Int64);
+typedef LiveMixerRenderToFileC = Int32 Function(Pointer<Void>, Pointer<Utf8>, Int32, Int64, Int64, Pointer<NativeFunction<RenderProgressC>>, Pointer<Void>);
+typedef LiveMixerRenderToFileDart = int Function(Pointer<Void>, Pointer<Utf8>, int, int, int, Pointer<NativeFunction<RenderProgressC>>, Pointer<Void>);
+typedef LiveMixerGetRenderStateC = Int32 Function(Pointer<Void>, Int32, Pointer<Int64>, Pointer<Int64>);
+typedef LiveMixerGetRenderStateDart = int Function(Pointer<Void>, int, Pointer<Int64>, Pointer<Int64>);
+
+// Handle-based track controls (no string marshalling per call)
+typedef LiveMixerTrackHandleC = Void Function(Pointer<Void>, Int32);
+typedef LiveMixerTrackHandleDart = void Function(Pointer<Void>, int);
+
+typedef LiveMixerSetTrackFloatC = Void Function(Pointer<Void>, Int32, Float);
+typedef LiveMixerSetTrackFloatDart = void Function(Pointer<Void>, int, double);
+
+typedef LiveMixerSetTrackBoolC = Void Function(Pointer<Void>, Int32, Bool);
+typedef LiveMixerSetTrackBoolDart = void Function(Pointer<Void>, int, bool);
+
 typedef LiveMixerSetLoopC = Void Function(Pointer<Void>, Int64, Int64, Bool);
 typedef LiveMixerSetLoopDart = void Function(Pointer<Void>, int, int, bool);
 
@@ -40,6 +99,55 @@ typedef LiveMixerGetPositionDart = int Function(Pointer<Void>);
 typedef LiveMixerProcessC = Int32 Function(Pointer<Void>, Pointer<Float>, Int32);
 typedef LiveMixerProcessDart = int Function(Pointer<Void>, Pointer<Float>, int);
 
+typedef LiveMixerProcessInt16C = Int32 Function(Pointer<Void>, Pointer<Int16>, Int32, Bool);
+typedef LiveMixerProcessInt16Dart = int Function(Pointer<Void>, Pointer<Int16>, int, bool);
+
+// Output device configuration. Layouts must match DeviceProfile / DeviceInfo in live_mixer.h.
+final class NativeDeviceProfile extends Struct {
+  @Int32() external int periodSizeInFrames;
+  @Int32() external int periodSizeInMilliseconds;
+  @Int32() external int periods;
+  @Int32() external int lowLatency;
+  @Int32() external int exclusive;
+  @Int32() external int backend;
+}
+
+final class NativeDeviceInfo extends Struct {
+  @Int32() external int backend;
+  @Int32() external int sampleRate;
+  @Int32() external int periodSizeInFrames;
+  @Int32() external int periods;
+  @Int32() external int exclusive;
+  @Int32() external int maxCallbackFrames;
+  @Int32() external int outputLatencyFrames;
+  @Int32() external int underruns;
+}
+
+final class NativePlaybackClock extends Struct {
+  @Int64() external int position;
+  @Int64() external int timestampNanos;
+  @Double() external double framesPerSecond;
+  @Int64() external int loopStart;
+  @Int64() external int loopEnd;
+}
+
+typedef DeviceProfileFields = ({int periodSizeInFrames, int periodSizeInMilliseconds, int periods, bool lowLatency, bool exclusive, int backend});
+typedef DeviceInfoFields = ({int backend, int sampleRate, int periodSizeInFrames, int periods, bool exclusive, int maxCallbackFrames, int outputLatencyFrames, int underruns});
+
+typedef PlaybackClockFields = ({int position, int timestampNanos, double framesPerSecond, int loopStart, int loopEnd});
+
+typedef LiveMixerGetPlaybackClockC = Bool Function(Pointer<Void>, Pointer<NativePlaybackClock>);
+typedef LiveMixerGetPlaybackClockDart = bool Function(Pointer<Void>, Pointer<NativePlaybackClock>);
+
+typedef LiveMixerCreateWithProfileC = Pointer<Void> Function(Pointer<NativeDeviceProfile>);
+typedef LiveMixerCreateWithProfileDart = Pointer<Void> Function(Pointer<NativeDeviceProfile>);
+
+typedef LiveMixerSetDeviceProfileC = Bool Function(Pointer<Void>, Pointer<NativeDeviceProfile>);
+typedef LiveMixerSetDeviceProfileDart = bool Function(Pointer<Void>, Pointer<NativeDeviceProfile>);
+
+typedef LiveMixerGetDeviceInfoC = Bool Function(Pointer<Void>, Pointer<NativeDeviceInfo>);
+typedef LiveMixerGetDeviceInfoDart = bool Function(Pointer<Void>, Pointer<NativeDeviceInfo>);
+
 class LiveMixerBindings {
   late DynamicLibrary _lib;
   
@@ -91,8 +199,68 @@ class LiveMixerBindings {
 
   Pointer<Void> create() => _create();
   void destroy(Pointer<Void> handle) => _destroy(handle);
+
+  // --- OUTPUT DEVICE ---
+  late final _createWithProfile = _lib.lookupFunction<LiveMixerCreateWithProfileC, LiveMixerCreateWithProfileDart>('live_mixer_create_with_profile');
+  late final _setDeviceProfile = _lib.lookupFunction<LiveMixerSetDeviceProfileC, LiveMixerSetDeviceProfileDart>('live_mixer_set_device_profile');
+  late final _getDeviceInfo = _lib.lookupFunction<LiveMixerGetDeviceInfoC, LiveMixerGetDeviceInfoDart>('live_mixer_get_device_info');
+
+  late final _setRenderAhead = _lib.lookupFunction<Void Function(Pointer<Void>, Int32), void Function(Pointer<Void>, int)>('live_mixer_set_render_ahead');
+  void setRenderAhead(Pointer<Void> mixer, int frames) => _setRenderAhead(mixer, frames);
+
+  Pointer<NativeDeviceProfile> _allocProfile(DeviceProfileFields profile) {
+      final ptr = calloc<NativeDeviceProfile>();
+      ptr.ref
+        ..periodSizeInFrames = profile.periodSizeInFrames
+        ..periodSizeInMilliseconds = profile.periodSizeInMilliseconds
+        ..periods = profile.periods
+        ..lowLatency = profile.lowLatency ? 1 : 0
+        ..exclusive = profile.exclusive ? 1 : 0
+        ..backend = profile.backend;
+      return ptr;
+  }
+
+  Pointer<Void> createWithProfile(DeviceProfileFields profile) {
+      final ptr = _allocProfile(profile);
+      final mixer = _createWithProfile(ptr);
+      calloc.free(ptr);
+      return mixer;
+  }
+
+  bool setDeviceProfile(Pointer<Void> mixer, DeviceProfileFields profile) {
+      final ptr = _allocProfile(profile);
+      final ok = _setDeviceProfile(mixer, ptr);
+      calloc.free(ptr);
+      return ok;
+  }
+
+  /// Negotiated device parameters, or null without an open device.
+  DeviceInfoFields? getDeviceInfo(Pointer<Void> mixer) {
+      final ptr = calloc<NativeDeviceInfo>();
+      DeviceInfoFields? result;
+      if (_getDeviceInfo(mixer, ptr)) {
+        final info = ptr.ref;
+        result = (
+          backend: info.backend,
+          sampleRate: info.sampleRate,
+          periodSizeInFrames: info.periodSizeInFrames,
+          periods: info.periods,
+          exclusive: info.exclusive != 0,
+          maxCallbackFrames: info.maxCallbackFrames,
+          outputLatencyFrames: info.outputLatencyFrames,
+          underruns: info.underruns,
+        );
+      }
+      calloc.free(ptr);
+      return result;
+  }
+
+  late final _getSampleRate = _lib.lookupFunction<Int32 Function(Pointer<Void>), int Function(Pointer<Void>)>('live_mixer_get_sample_rate');
+  int getSampleRate(Pointer<Void> mixer) => _getSampleRate(mixer);
+  late final _addTrackAtRate = _lib.lookupFunction<LiveMixerAddTrackAtRateC, LiveMixerAddTrackAtRateDart>('live_mixer_add_track_at_rate');
   
-  void addTrack(Pointer<Void> mixer, String id, List<double> data, int channels) {
+  /// Returns the track handle, or -1 on failure.
+  int addTrack(Pointer<Void> mixer, String id, List<double> data, int channels) {
       final idPtr = id.toNativeUtf8();
       
       final dataPtr = calloc<Float>(data.length);
@@ -100,14 +268,17 @@ class LiveMixerBindings {
           dataPtr[i] = data[i];
       }
       
-      _addTrack(mixer, idPtr, dataPtr, data.length, channels);
+      final handle = _addTrack(mixer, idPtr, dataPtr, data.length, channels);
       
       calloc.free(dataPtr);
       calloc.free(idPtr);
+      return handle;
   }
 
   // --- OPTIMIZED FLOAT32 PATH ---
-  void addTrackFloat32(Pointer<Void> mixer, String id, Float32List data, int channels) {
+  /// Returns the track handle, or -1 on failure.
+  /// [sampleRate] of [data]; 0 means it is already at the mixer rate.
+  int addTrackFloat32(Pointer<Void> mixer, String id, Float32List data, int channels, {int sampleRate = 0}) {
       final idPtr = id.toNativeUtf8();
       
       // Get pointer directly from Float32List?
@@ -132,10 +303,20 @@ class LiveMixerBindings {
       final list = ptr.asTypedList(data.length); 
       list.setAll(0, data); // Fast memcpy
       
-      _addTrack(mixer, idPtr, ptr, data.length, channels);
+      final handle = sampleRate == 0
+          ? _addTrack(mixer, idPtr, ptr, data.length, channels)
+          : _addTrackAtRate(mixer, idPtr, ptr, data.length, channels, sampleRate);
       
       calloc.free(ptr);
       calloc.free(idPtr);
+      return handle;
+  }
+
+  int getTrackHandle(Pointer<Void> mixer, String id) {
+      final idPtr = id.toNativeUtf8();
+      final handle = _getTrackHandle(mixer, idPtr);
+      calloc.free(idPtr);
+      return handle;
   }
   
   void removeTrack(Pointer<Void> mixer, String id) {
@@ -168,6 +349,134 @@ class LiveMixerBindings {
       calloc.free(idPtr);
   }
 
+  // --- ZERO-COPY TRACK REGISTRATION ---
+  late final _createTrack = _lib.lookupFunction<LiveMixerCreateTrackC, LiveMixerCreateTrackDart>('live_mixer_create_track');
+  late final _getTrackBuffer = _lib.lookupFunction<LiveMixerGetTrackBufferC, LiveMixerGetTrackBufferDart>('live_mixer_get_track_buffer');
+  late final _commitTrack = _lib.lookupFunction<LiveMixerCommitTrackC, LiveMixerCommitTrackDart>('live_mixer_commit_track');
+  late final _adoptTrack = _lib.lookupFunction<LiveMixerAdoptTrackC, LiveMixerAdoptTrackDart>('live_mixer_adopt_track');
+
+  int createTrack(Pointer<Void> mixer, String id, int numSamples, int channels) {
+      final idPtr = id.toNativeUtf8();
+      final handle = _createTrack(mixer, idPtr, numSamples, channels);
+      calloc.free(idPtr);
+      return handle;
+  }
+
+  Pointer<Float> getTrackBuffer(Pointer<Void> mixer, int handle) => _getTrackBuffer(mixer, handle);
+  bool commitTrack(Pointer<Void> mixer, int handle) => _commitTrack(mixer, handle);
+
+  /// [data] must come from package:ffi `malloc`; it is released with `malloc.nativeFree`
+  /// when the mixer drops the track.
+  int adoptTrack(Pointer<Void> mixer, String id, Pointer<Float> data, int numSamples, int channels) {
+      final idPtr = id.toNativeUtf8();
+      final handle = _adoptTrack(mixer, idPtr, data, numSamples, channels, malloc.nativeFree, data.cast<Void>());
+      calloc.free(idPtr);
+      return handle;
+  }
+
+  // --- MEMORY-MAPPED TRACKS ---
+  late final _mapTrackFile = _lib.lookupFunction<LiveMixerMapTrackFileC, LiveMixerMapTrackFileDart>('live_mixer_map_track_file');
+
+  /// Maps a 32-bit float WAV (or raw float file with [channels]) from disk.
+  /// Returns the track handle, or -1 on failure.
+  int mapTrackFile(Pointer<Void> mixer, String id, String path, int channels) {
+      final idPtr = id.toNativeUtf8();
+      final pathPtr = path.toNativeUtf8();
+      final handle = _mapTrackFile(mixer, idPtr, pathPtr, channels);
+      calloc.free(pathPtr);
+      calloc.free(idPtr);
+      return handle;
+  }
+
+  // --- COMPRESSED TRACKS ---
+  late final _addCompressedTrack = _lib.lookupFunction<LiveMixerAddCompressedTrackC, LiveMixerAddCompressedTrackDart>('live_mixer_add_compressed_track');
+
+  /// [codec]: 0 = float32, 1 = int16, 2 = lossless. Returns the track handle, or -1 on failure.
+  int addCompressedTrack(Pointer<Void> mixer, String id, Float32List data, int channels, int codec, int sampleRate) {
+      final idPtr = id.toNativeUtf8();
+      final ptr = calloc<Float>(data.length);
+      ptr.asTypedList(data.length).setAll(0, data);
+
+      final handle = _addCompressedTrack(mixer, idPtr, ptr, data.length, channels, codec, sampleRate);
+
+      calloc.free(ptr);
+      calloc.free(idPtr);
+      return handle;
+  }
+
+  // --- NATIVE FILE DECODING ---
+  late final _addTrackFromFile = _lib.lookupFunction<LiveMixerAddTrackFromFileC, LiveMixerAddTrackFromFileDart>('live_mixer_add_track_from_file');
+  late final _addTrackFromMemory = _lib.lookupFunction<LiveMixerAddTrackFromMemoryC, LiveMixerAddTrackFromMemoryDart>('live_mixer_add_track_from_memory');
+  late final _getTrackLoadState = _lib.lookupFunction<LiveMixerGetTrackLoadStateC, LiveMixerGetTrackLoadStateDart>('live_mixer_get_track_load_state');
+  late final _getTrackInfo = _lib.lookupFunction<LiveMixerGetTrackInfoC, LiveMixerGetTrackInfoDart>('live_mixer_get_track_info');
+  late final _getTrackPeaks = _lib.lookupFunction<LiveMixerGetTrackPeaksC, LiveMixerGetTrackPeaksDart>('live_mixer_get_track_peaks');
+
+  /// Queues a native decode of [path]. Returns the track handle, or -1 on failure.
+  int addTrackFromFile(Pointer<Void> mixer, String id, String path) {
+      final idPtr = id.toNativeUtf8();
+      final pathPtr = path.toNativeUtf8();
+      final handle = _addTrackFromFile(mixer, idPtr, pathPtr, nullptr, nullptr);
+      calloc.free(pathPtr);
+      calloc.free(idPtr);
+      return handle;
+  }
+
+  /// Queues a native decode of an encoded file held in [encoded] (e.g. an asset).
+  /// The bytes are staged in a `malloc` buffer that the mixer frees after decoding.
+  int addTrackFromMemory(Pointer<Void> mixer, String id, Uint8List encoded) {
+      final idPtr = id.toNativeUtf8();
+      final data = malloc<Uint8>(encoded.length);
+      data.asTypedList(encoded.length).setAll(0, encoded);
+
+      final handle = _addTrackFromMemory(mixer, idPtr, data, encoded.length, malloc.nativeFree, data.cast<Void>(), nullptr, nullptr);
+      if (handle < 0) malloc.free(data);
+
+      calloc.free(idPtr);
+      return handle;
+  }
+
+  /// (state, decodedFrames, totalFrames); state is -1 failed, 0 loading, 1 ready.
+  (int, int, int) getTrackLoadState(Pointer<Void> mixer, int handle) {
+      final frames = calloc<Int64>(2);
+      final state = _getTrackLoadState(mixer, handle, frames, frames + 1);
+      final result = (state, frames[0], frames[1]);
+      calloc.free(frames);
+      return result;
+  }
+
+  /// (frames, channels), or null if the track has no audio yet.
+  (int, int)? getTrackInfo(Pointer<Void> mixer, int handle) {
+      final frames = calloc<Int64>();
+      final channels = calloc<Int32>();
+      final ok = _getTrackInfo(mixer, handle, frames, channels);
+      final result = ok ? (frames.value, channels.value) : null;
+      calloc.free(channels);
+      calloc.free(frames);
+      return result;
+  }
+
+  Float32List? getTrackPeaks(Pointer<Void> mixer, int handle, int channel, int points) {
+      final out = calloc<Float>(points);
+      final written = _getTrackPeaks(mixer, handle, channel, out, points);
+      final result = written > 0 ? Float32List.fromList(out.asTypedList(written)) : null;
+      calloc.free(out);
+      return result;
+  }
+
+  // --- HANDLE-BASED TRACK CONTROLS ---
+  late final _getTrackHandle = _lib.lookupFunction<LiveMixerGetTrackHandleC, LiveMixerGetTrackHandleDart>('live_mixer_get_track_handle');
+  late final _removeTrackHandle = _lib.lookupFunction<LiveMixerTrackHandleC, LiveMixerTrackHandleDart>('live_mixer_remove_track_handle');
+  late final _setTrackVolume = _lib.lookupFunction<LiveMixerSetTrackFloatC, LiveMixerSetTrackFloatDart>('live_mixer_set_track_volume');
+  late final _setTrackPan = _lib.lookupFunction<LiveMixerSetTrackFloatC, LiveMixerSetTrackFloatDart>('live_mixer_set_track_pan');
+  late final _setTrackMute = _lib.lookupFunction<LiveMixerSetTrackBoolC, LiveMixerSetTrackBoolDart>('live_mixer_set_track_mute');
+  late final _setTrackSolo = _lib.lookupFunction<LiveMixerSetTrackBoolC, LiveMixerSetTrackBoolDart>('live_mixer_set_track_solo');
+
+  void removeTrackHandle(Pointer<Void> mixer, int handle) => _removeTrackHandle(mixer, handle);
+  void setTrackVolume(Pointer<Void> mixer, int handle, double volume) => _setTrackVolume(mixer, handle, volume);
+  void setTrackPan(Pointer<Void> mixer, int handle, double pan) => _setTrackPan(mixer, handle, pan);
+  void setTrackMute(Pointer<Void> mixer, int handle, bool muted) => _setTrackMute(mixer, handle, muted);
+  void setTrackSolo(Pointer<Void> mixer, int handle, bool solo) => _setTrackSolo(mixer, handle, solo);
+
   void setLoop(Pointer<Void> mixer, int start, int end, bool enabled) {
       _setLoop(mixer, start, end, enabled);
   }
@@ -184,17 +493,101 @@ class LiveMixerBindings {
   int process(Pointer<Void> mixer, Pointer<Float> output, int frames) {
       return _process(mixer, output, frames);
   }
+
+  late final _processInt16 = _lib.lookupFunction<LiveMixerProcessInt16C, LiveMixerProcessInt16Dart>('live_mixer_process_int16');
+
+  // Same as process(), converted natively to clamped 16-bit PCM (TPDF dither optional).
+  int processInt16(Pointer<Void> mixer, Pointer<Int16> output, int frames, bool dither) {
+      return _processInt16(mixer, output, frames, dither);
+  }
   
   // --- NATIVE OUTPUT BINDINGS ---
   late final _start = _lib.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>('live_mixer_start');
   late final _stop = _lib.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>('live_mixer_stop');
   late final _getAtomicPosition = _lib.lookupFunction<Int64 Function(Pointer<Void>), int Function(Pointer<Void>)>('live_mixer_get_atomic_position');
+  late final _isStalled = _lib.lookupFunction<Bool Function(Pointer<Void>), bool Function(Pointer<Void>)>('live_mixer_is_stalled');
   late final _setSpeed = _lib.lookupFunction<Void Function(Pointer<Void>, Float), void Function(Pointer<Void>, double)>('live_mixer_set_speed');
   late final _setSoundTouchSetting = _lib.lookupFunction<Void Function(Pointer<Void>, Int32, Int32), void Function(Pointer<Void>, int, int)>('live_mixer_set_soundtouch_setting');
 
   void start(Pointer<Void> mixer) => _start(mixer);
   void stop(Pointer<Void> mixer) => _stop(mixer);
   int getAtomicPosition(Pointer<Void> mixer) => _getAtomicPosition(mixer);
+
+  late final _getPlaybackClock = _lib.lookupFunction<LiveMixerGetPlaybackClockC, LiveMixerGetPlaybackClockDart>('live_mixer_get_playback_clock');
+
+  PlaybackClockFields? getPlaybackClock(Pointer<Void> mixer) {
+      final ptr = calloc<NativePlaybackClock>();
+      PlaybackClockFields? result;
+      if (_getPlaybackClock(mixer, ptr)) {
+        final clock = ptr.ref;
+        result = (
+          position: clock.position,
+          timestampNanos: clock.timestampNanos,
+          framesPerSecond: clock.framesPerSecond,
+          loopStart: clock.loopStart,
+          loopEnd: clock.loopEnd,
+        );
+      }
+      calloc.free(ptr);
+      return result;
+  }
+  bool isStalled(Pointer<Void> mixer) => _isStalled(mixer);
   void setSpeed(Pointer<Void> mixer, double speed) => _setSpeed(mixer, speed);
   void setSoundTouchSetting(Pointer<Void> mixer, int settingId, int value) => _setSoundTouchSetting(mixer, settingId, value);
+
+  // --- STRETCH ENGINE ---
+  late final _setStretchEngine = _lib.lookupFunction<Void Function(Pointer<Void>, Int32), void Function(Pointer<Void>, int)>('live_mixer_set_stretch_engine');
+  late final _getStretchEngine = _lib.lookupFunction<Int32 Function(Pointer<Void>), int Function(Pointer<Void>)>('live_mixer_get_stretch_engine');
+  late final _setVocoderFrame = _lib.lookupFunction<Void Function(Pointer<Void>, Int32, Int32), void Function(Pointer<Void>, int, int)>('live_mixer_set_vocoder_frame');
+
+  void setStretchEngine(Pointer<Void> mixer, int engine) => _setStretchEngine(mixer, engine);
+  int getStretchEngine(Pointer<Void> mixer) => _getStretchEngine(mixer);
+  void setVocoderFrame(Pointer<Void> mixer, int fftSize, int overlap) => _setVocoderFrame(mixer, fftSize, overlap);
+
+  // --- STRETCH GROUPS ---
+  late final _setTrackStretchGroup = _lib.lookupFunction<Bool Function(Pointer<Void>, Int32, Int32), bool Function(Pointer<Void>, int, int)>('live_mixer_set_track_stretch_group');
+  late final _setStretchGroupSetting = _lib.lookupFunction<Void Function(Pointer<Void>, Int32, Int32, Int32), void Function(Pointer<Void>, int, int, int)>('live_mixer_set_stretch_group_setting');
+  late final _setStretchGroupVocoderFrame = _lib.lookupFunction<Void Function(Pointer<Void>, Int32, Int32, Int32), void Function(Pointer<Void>, int, int, int)>('live_mixer_set_stretch_group_vocoder_frame');
+
+  bool setTrackStretchGroup(Pointer<Void> mixer, int handle, int group) => _setTrackStretchGroup(mixer, handle, group);
+  void setStretchGroupSetting(Pointer<Void> mixer, int group, int settingId, int value) => _setStretchGroupSetting(mixer, group, settingId, value);
+  void setStretchGroupVocoderFrame(Pointer<Void> mixer, int group, int fftSize, int overlap) => _setStretchGroupVocoderFrame(mixer, group, fftSize, overlap);
+
+  // --- RENDERED-LOOP CACHE ---
+  late final _setLoopCacheEnabled = _lib.lookupFunction<Void Function(Pointer<Void>, Bool), void Function(Pointer<Void>, bool)>('live_mixer_set_loop_cache_enabled');
+  late final _isPlayingFromLoopCache = _lib.lookupFunction<Bool Function(Pointer<Void>), bool Function(Pointer<Void>)>('live_mixer_is_playing_from_loop_cache');
+
+  void setLoopCacheEnabled(Pointer<Void> mixer, bool enabled) => _setLoopCacheEnabled(mixer, enabled);
+  bool isPlayingFromLoopCache(Pointer<Void> mixer) => _isPlayingFromLoopCache(mixer);
+
+  // --- PRE-STRETCHED STEMS ---
+  late final _setPreStretchBudget = _lib.lookupFunction<Void Function(Pointer<Void>, Int64), void Function(Pointer<Void>, int)>('live_mixer_set_pre_stretch_budget');
+  late final _isPlayingPreStretched = _lib.lookupFunction<Bool Function(Pointer<Void>), bool Function(Pointer<Void>)>('live_mixer_is_playing_pre_stretched');
+
+  void setPreStretchBudget(Pointer<Void> mixer, int bytes) => _setPreStretchBudget(mixer, bytes);
+  bool isPlayingPreStretched(Pointer<Void> mixer) => _isPlayingPreStretched(mixer);
+
+  // --- OFFLINE EXPORT ---
+  late final _renderToFile = _lib.lookupFunction<LiveMixerRenderToFileC, LiveMixerRenderToFileDart>('live_mixer_render_to_file');
+  late final _getRenderState = _lib.lookupFunction<LiveMixerGetRenderStateC, LiveMixerGetRenderStateDart>('live_mixer_get_render_state');
+  late final _cancelRender = _lib.lookupFunction<Void Function(Pointer<Void>, Int32), void Function(Pointer<Void>, int)>('live_mixer_cancel_render');
+
+  /// Starts a native export to [path]. Returns the job id, or -1 on failure.
+  int renderToFile(Pointer<Void> mixer, String path, int format, int startFrame, int endFrame) {
+      final pathPtr = path.toNativeUtf8();
+      final job = _renderToFile(mixer, pathPtr, format, startFrame, endFrame, nullptr, nullptr);
+      calloc.free(pathPtr);
+      return job;
+  }
+
+  /// (state, framesWritten, totalFrames); state is -1 failed, 0 running, 1 done, 2 cancelled.
+  (int, int, int) getRenderState(Pointer<Void> mixer, int job) {
+      final frames = calloc<Int64>(2);
+      final state = _getRenderState(mixer, job, frames, frames + 1);
+      final result = (state, frames[0], frames[1]);
+      calloc.free(frames);
+      return result;
+  }
+
+  void cancelRender(Pointer<Void> mixer, int job) => _cancelRender(mixer, job);
 }
@@ -1,5 +1,8 @@
 #include "Vocoder.h"
+#include "pv_kernels.h"
+#include <algorithm>
 #include <iostream>
+#include <map>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -13,28 +16,123 @@ static void createHanningWindow(std::vector<float>& window, int size) {
     }
 }
 
+static size_t nextPowerOfTwo(size_t n) {
+    size_t size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+static int powerOfTwoIn(int value, int lo, int hi) {
+    return static_cast<int>(nextPowerOfTwo(static_cast<size_t>(std::min(std::max(value, lo), hi))));
+}
+
+// --- PLAN CACHE ---
+// Process-wide and keyed by FFT size. The window is immutable and shared by
+// every instance of a size. A kiss_fftr config also holds the scratch of the
+// transform in progress, so a plan is lent to one instance at a time and kept
+// for the next one when that goes: stretchers are created for every export
+// segment, loop render and pre-stretched stem, and those then build no FFT
+// state. Never destroyed, so instances outliving static destruction are safe.
+struct Vocoder::FftPlan {
+    int fftSize;
+    kiss_fftr_cfg forward;
+    kiss_fftr_cfg inverse;
+};
+
+struct Vocoder::PlanCache {
+    std::mutex mutex;
+    std::map<int, std::vector<FftPlan*>> idle;
+    std::map<int, std::shared_ptr<const std::vector<float>>> windows;
+
+    static PlanCache& instance() {
+        static PlanCache* cache = new PlanCache();
+        return *cache;
+    }
+
+    FftPlan* acquire(int fftSize) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<FftPlan*>& plans = idle[fftSize];
+            if (!plans.empty()) {
+                FftPlan* plan = plans.back();
+                plans.pop_back();
+                return plan;
+            }
+        }
+        FftPlan* plan = new FftPlan();
+        plan->fftSize = fftSize;
+        plan->forward = kiss_fftr_alloc(fftSize, 0, NULL, NULL);
+        plan->inverse = kiss_fftr_alloc(fftSize, 1, NULL, NULL);
+        return plan;
+    }
+
+    void release(FftPlan* plan) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle[plan->fftSize].push_back(plan);
+    }
+
+    std::shared_ptr<const std::vector<float>> window(int fftSize) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const std::vector<float>>& window = windows[fftSize];
+        if (!window) {
+            std::shared_ptr<std::vector<float>> hann = std::make_shared<std::vector<float>>();
+            createHanningWindow(*hann, fftSize);
+            window = hann;
+        }
+        return window;
+    }
+};
+
+void Vocoder::SampleRing::init(size_t capacity) {
+    data.assign(nextPowerOfTwo(capacity), 0.0f);
+    mask = data.size() - 1;
+    readPos = writePos = 0;
+}
+
+void Vocoder::SampleRing::grow(size_t capacity) {
+    if (capacity <= data.size()) return;
+    std::vector<float> queued(size());
+    peek(queued.data(), 0, queued.size());
+    init(capacity);
+    memcpy(data.data(), queued.data(), queued.size() * sizeof(float));
+    writePos = queued.size();
+}
+
+void Vocoder::SampleRing::peek(float* out, size_t offset, size_t count) const {
+    size_t start = static_cast<size_t>(readPos + offset) & mask;
+    size_t first = std::min(count, data.size() - start);
+    memcpy(out, data.data() + start, first * sizeof(float));
+    memcpy(out + first, data.data(), (count - first) * sizeof(float));
+}
+
 Vocoder::ChannelState::ChannelState(int fftSize) {
-    inputBuffer.reserve(fftSize * 2);
-    outputBuffer.reserve(fftSize * 2);
-    overlapBuffer.assign(fftSize, 0.0f);
-    lastPhase.assign(fftSize, 0.0f);
-    sumPhase.assign(fftSize, 0.0f);
-    magCache.assign(fftSize, 0.0f);
-    phaseCache.assign(fftSize, 0.0f);
-    createHanningWindow(analysisWindow, fftSize);
-    createHanningWindow(synthesisWindow, fftSize);
+    int numBins = fftSize / 2 + 1;
+    // Input only ever holds one frame: hops are processed as soon as it's full
+    input.init(fftSize);
+    output.init(fftSize * 8);
+    overlapBuffer.assign(nextPowerOfTwo(fftSize), 0.0f);
+    overlapMask = overlapBuffer.size() - 1;
+    overlapPos = 0;
+    lastPhase.assign(numBins, 0.0f);
+    sumPhase.assign(numBins, 0.0f);
+    magCache.assign(numBins, 0.0f);
+    phaseCache.assign(numBins, 0.0f);
     lastEnergy = 0.0f;
     transientCooldown = 0;
 }
 
-Vocoder::Vocoder(int sampleRate, int channels) 
-    : _sampleRate(sampleRate), _channels(channels), _speed(1.0f), _fftSize(2048) {
+Vocoder::Vocoder(int sampleRate, int channels, int fftSize, int overlap) 
+    : _sampleRate(sampleRate), _channels(channels), _speed(1.0f), _hopCarry(0.0) {
     
-    _fftCfg = kiss_fft_alloc(_fftSize, 0, NULL, NULL);
-    _ifftCfg = kiss_fft_alloc(_fftSize, 1, NULL, NULL);
+    _fftSize = powerOfTwoIn(fftSize, kMinFftSize, kMaxFftSize);
+    _overlap = powerOfTwoIn(overlap, 4, 16);
+    _numBins = _fftSize / 2 + 1;
+    PlanCache& plans = PlanCache::instance();
+    _plan = plans.acquire(_fftSize);
+    _window = plans.window(_fftSize);
     
-    _fftIn.resize(_fftSize);
-    _fftOut.resize(_fftSize);
+    _frame.resize(_fftSize);
+    _spectrum.resize(_numBins);
     
     for (int i = 0; i < _channels; ++i) {
         _ch.emplace_back(_fftSize);
@@ -44,8 +142,7 @@ Vocoder::Vocoder(int sampleRate, int channels)
 }
 
 Vocoder::~Vocoder() {
-    free(_fftCfg);
-    free(_ifftCfg);
+    PlanCache::instance().release(_plan);
 }
 
 void Vocoder::setTempo(float speed) {
@@ -57,54 +154,83 @@ void Vocoder::setTempo(float speed) {
 }
 
 void Vocoder::_updateHopSizes() {
-    // 75% overlap for high quality (hop = size / 4)
-    _hopSizeOut = _fftSize / 4; 
+    // 75% overlap by default for high quality (hop = size / 4)
+    _hopSizeOut = _fftSize / _overlap; 
     _hopSizeIn = static_cast<int>((float)_hopSizeOut * _speed);
     
     // Safety check
     if (_hopSizeIn < 1) _hopSizeIn = 1;
 }
 
+int Vocoder::numSamples() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return static_cast<int>(_ch[0].output.size());
+}
+
+int Vocoder::numUnprocessedSamples() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return static_cast<int>(_ch[0].input.size());
+}
+
 void Vocoder::clear() {
     std::lock_guard<std::mutex> lock(_mutex);
     for (int i = 0; i < _channels; ++i) {
-        _ch[i].inputBuffer.clear();
-        _ch[i].outputBuffer.clear();
+        _ch[i].input.clear();
+        _ch[i].output.clear();
         std::fill(_ch[i].overlapBuffer.begin(), _ch[i].overlapBuffer.end(), 0.0f);
+        _ch[i].overlapPos = 0;
         std::fill(_ch[i].lastPhase.begin(), _ch[i].lastPhase.end(), 0.0f);
         std::fill(_ch[i].sumPhase.begin(), _ch[i].sumPhase.end(), 0.0f);
         _ch[i].lastEnergy = 0.0f;
         _ch[i].transientCooldown = 0;
     }
+    _hopCarry = 0.0;
 }
 
 void Vocoder::putSamples(const float* stereoInput, int numFrames) {
     std::lock_guard<std::mutex> lock(_mutex);
-    
-    // De-interleave and buffer
-    for (int i = 0; i < numFrames; ++i) {
-        for (int c = 0; c < _channels; ++c) {
-            _ch[c].inputBuffer.push_back(stereoInput[i * _channels + c]);
-        }
-    }
-    
-    // Process full chunks
-    while (true) {
-        bool canProcess = true;
+    _put(stereoInput, numFrames);
+}
+
+void Vocoder::flush() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _put(nullptr, _fftSize);
+}
+
+void Vocoder::_put(const float* input, int numFrames) {
+    // De-interleave into the input rings a frame's worth at a time and
+    // process each hop as soon as a full frame is buffered
+    int done = 0;
+    while (done < numFrames) {
+        int count = std::min(numFrames - done, static_cast<int>(_ch[0].input.space()));
         for (int c = 0; c < _channels; ++c) {
-            if (_ch[c].inputBuffer.size() < _fftSize) {
-                canProcess = false;
-                break;
+            SampleRing& ring = _ch[c].input;
+            if (!input) {
+                for (int i = 0; i < count; ++i) ring.at(ring.writePos + i) = 0.0f;
+            } else {
+                const float* src = input + static_cast<size_t>(done) * _channels + c;
+                for (int i = 0; i < count; ++i) {
+                    ring.at(ring.writePos + i) = src[i * _channels];
+                }
             }
+            ring.writePos += count;
         }
+        done += count;
         
-        if (!canProcess) break;
-        
-        for (int c = 0; c < _channels; ++c) {
-            _processChannel(c);
+        while (_ch[0].input.size() >= static_cast<size_t>(_fftSize)) {
+            for (int c = 0; c < _channels; ++c) {
+                _processChannel(c);
+            }
             
-            // Advance input buffer by Analysis Hop Size
-            _ch[c].inputBuffer.erase(_ch[c].inputBuffer.begin(), _ch[c].inputBuffer.begin() + _hopSizeIn);
+            // Advance input by Analysis Hop Size: whole samples, carrying the
+            // fraction so that the hops average exactly speed * hopOut and
+            // the output keeps to the tempo's time map
+            double hop = _hopSizeOut * static_cast<double>(_speed) + _hopCarry;
+            _hopSizeIn = std::max(1, static_cast<int>(hop));
+            _hopCarry = hop - _hopSizeIn;
+            for (int c = 0; c < _channels; ++c) {
+                _ch[c].input.readPos += _hopSizeIn;
+            }
         }
     }
 }
@@ -112,24 +238,18 @@ void Vocoder::putSamples(const float* stereoInput, int numFrames) {
 void Vocoder::_processChannel(int chIdx) {
     ChannelState& state = _ch[chIdx];
     
-    // 1. Ingest, Window and FFT
+    // 1. Ingest, Window and real FFT (bins 0..N/2)
+    const float* window = _window->data();
+    state.input.peek(_frame.data(), 0, _fftSize);
     for (int i = 0; i < _fftSize; ++i) {
-        _fftIn[i].r = state.inputBuffer[i] * state.analysisWindow[i];
-        _fftIn[i].i = 0.0f;
+        _frame[i] *= window[i];
     }
     
-    kiss_fft(_fftCfg, _fftIn.data(), _fftOut.data());
-    
-    // 2. Magnitude, Phase and Transient Detection (Optimized with Nyquist Mirrors)
-    float currentEnergy = 0.0f;
-    int halfSize = _fftSize / 2;
+    kiss_fftr(_plan->forward, _frame.data(), _spectrum.data());
     
-    // Process only up to Nyquist limit (0 to N/2) since input is purely real
-    for (int k = 0; k <= halfSize; ++k) {
-        state.magCache[k] = std::sqrt(_fftOut[k].r * _fftOut[k].r + _fftOut[k].i * _fftOut[k].i);
-        state.phaseCache[k] = std::atan2(_fftOut[k].i, _fftOut[k].r);
-        currentEnergy += state.magCache[k] * state.magCache[k];
-    }
+    // 2. Magnitude, Phase and Transient Detection (one SIMD pass over the bins)
+    float* bins = reinterpret_cast<float*>(_spectrum.data());
+    float currentEnergy = pv_analyze(bins, state.magCache.data(), state.phaseCache.data(), _numBins);
     
     float energyRatio = currentEnergy / (state.lastEnergy + 1e-7f);
     bool isTransient = (energyRatio > 2.5f);
@@ -139,104 +259,71 @@ void Vocoder::_processChannel(int chIdx) {
     float expectedSynthesisAdvance = 2.0f * M_PI * _hopSizeOut / _fftSize;
     
     if (isTransient && state.transientCooldown == 0) {
-        // Transient Hit: Force Phase Reset to preserve punch
+        // Transient Hit: Force Phase Reset to preserve punch. The spectrum
+        // is resynthesized with its own phases, i.e. left as analysed.
         state.transientCooldown = 3; 
-        for (int k = 0; k <= halfSize; ++k) {
-            state.sumPhase[k] = state.phaseCache[k];
-            state.lastPhase[k] = state.phaseCache[k];
-            
-            _fftOut[k].r = state.magCache[k] * std::cos(state.sumPhase[k]);
-            _fftOut[k].i = state.magCache[k] * std::sin(state.sumPhase[k]);
-        }
+        std::copy(state.phaseCache.begin(), state.phaseCache.end(), state.sumPhase.begin());
+        std::copy(state.phaseCache.begin(), state.phaseCache.end(), state.lastPhase.begin());
     } else {
         if (state.transientCooldown > 0) {
             state.transientCooldown--;
         }
         
         // Standard Phase Vocoder Advance
-        for (int k = 0; k <= halfSize; ++k) {
-            float phaseDiff = state.phaseCache[k] - state.lastPhase[k];
-            state.lastPhase[k] = state.phaseCache[k];
-            
-            float binDeviation = phaseDiff - (float)k * expectedPhaseAdvance;
-            
-            // Fast wrap to [-pi, pi]
-            while (binDeviation > M_PI) binDeviation -= 2.0f * M_PI;
-            while (binDeviation < -M_PI) binDeviation += 2.0f * M_PI;
-            
-            float trueFreqDev = binDeviation / _hopSizeIn; 
-            
-            state.sumPhase[k] += ((float)k * 2.0f * M_PI / _fftSize + trueFreqDev) * _hopSizeOut;
-            
-            // Fast wrap synthesize phase
-            while (state.sumPhase[k] > M_PI) state.sumPhase[k] -= 2.0f * M_PI;
-            while (state.sumPhase[k] < -M_PI) state.sumPhase[k] += 2.0f * M_PI;
-            
-            _fftOut[k].r = state.magCache[k] * std::cos(state.sumPhase[k]);
-            _fftOut[k].i = state.magCache[k] * std::sin(state.sumPhase[k]);
-        }
+        pv_advance(bins, state.magCache.data(), state.phaseCache.data(),
+                   state.lastPhase.data(), state.sumPhase.data(), _numBins,
+                   expectedPhaseAdvance, expectedSynthesisAdvance, (float)_hopSizeOut / _hopSizeIn);
     }
     
-    // Reconstruct the top half using complex conjugates (Real FFT symmetry)
-    for (int k = halfSize + 1; k < _fftSize; ++k) {
-        _fftOut[k].r = _fftOut[_fftSize - k].r;
-        _fftOut[k].i = -_fftOut[_fftSize - k].i;
-    }
-    
-    // 3. IFFT and Windowing
-    // Note: KissFFT in-place or out-of-place. We put modified frequency data in _fftOut,
-    // so we must configure KissFFT to read from _fftOut and write to _fftIn (time domain).
-    kiss_fft(_ifftCfg, _fftOut.data(), _fftIn.data());
+    // 3. Inverse real FFT (the upper half is implied by symmetry) and Windowing
+    kiss_fftri(_plan->inverse, _spectrum.data(), _frame.data());
     
     // 4. Overlap-Add Output Generation
     // KissFFT's inverse transform scales by N, so we must divide by N (_fftSize)
-    // The overlap of Hanning windows (hop = N/4) sums to roughly 1.5, we tune the scale.
-    float scale = 1.0f / ((float)_fftSize * 1.5f); 
+    // The overlap of squared Hanning windows (hop = N/overlap) sums to roughly
+    // 3/8 of the overlap (1.5 at N/4), we tune the scale.
+    float scale = 1.0f / ((float)_fftSize * (0.375f * _overlap)); 
     
+    uint64_t pos = state.overlapPos;
     for (int i = 0; i < _fftSize; ++i) {
-        state.overlapBuffer[i] += _fftIn[i].r * state.synthesisWindow[i] * scale;
-    }
-    
-    // Extract finished hop to the output FIFO
-    for (int i = 0; i < _hopSizeOut; ++i) {
-        state.outputBuffer.push_back(state.overlapBuffer[i]);
+        state.overlapBuffer[(pos + i) & state.overlapMask] += _frame[i] * window[i] * scale;
     }
     
-    // Shift accumulator left 
-    for (int i = 0; i < _fftSize - _hopSizeOut; ++i) {
-        state.overlapBuffer[i] = state.overlapBuffer[i + _hopSizeOut];
+    // Move the finished hop to the output FIFO and clear its slots for the
+    // tail of later frames
+    SampleRing& output = state.output;
+    if (output.space() < static_cast<size_t>(_hopSizeOut)) {
+        output.grow(output.data.size() * 2);
     }
-    
-    // Zero out the tail
-    for (int i = _fftSize - _hopSizeOut; i < _fftSize; ++i) {
-        state.overlapBuffer[i] = 0.0f;
+    for (int i = 0; i < _hopSizeOut; ++i) {
+        float& slot = state.overlapBuffer[(pos + i) & state.overlapMask];
+        output.at(output.writePos + i) = slot;
+        slot = 0.0f;
     }
+    output.writePos += _hopSizeOut;
+    state.overlapPos = pos + _hopSizeOut;
 }
 
 int Vocoder::receiveSamples(float* stereoOutput, int maxFrames) {
     std::lock_guard<std::mutex> lock(_mutex);
     
     // Find how many frames we can actually output
-    int availableFrames = _ch[0].outputBuffer.size(); 
+    size_t availableFrames = _ch[0].output.size();
     for (int c = 1; c < _channels; ++c) {
-        int avail = _ch[c].outputBuffer.size();
-        if (avail < availableFrames) availableFrames = avail;
+        availableFrames = std::min(availableFrames, _ch[c].output.size());
     }
     
-    if (availableFrames <= 0) return 0;
-    
-    int framesToOutput = std::min(availableFrames, maxFrames);
+    if (availableFrames == 0 || maxFrames <= 0) return 0;
     
-    // Interleave and output
-    for (int i = 0; i < framesToOutput; ++i) {
-        for (int c = 0; c < _channels; ++c) {
-            stereoOutput[i * _channels + c] = _ch[c].outputBuffer[i];
-        }
-    }
+    int framesToOutput = static_cast<int>(std::min(availableFrames, static_cast<size_t>(maxFrames)));
     
-    // Erase consumed frames
+    // Interleave straight from the rings into the caller's buffer
     for (int c = 0; c < _channels; ++c) {
-        _ch[c].outputBuffer.erase(_ch[c].outputBuffer.begin(), _ch[c].outputBuffer.begin() + framesToOutput);
+        SampleRing& output = _ch[c].output;
+        for (int i = 0; i < framesToOutput; ++i) {
+            stereoOutput[i * _channels + c] = output.at(output.readPos + i);
+        }
+        output.readPos += framesToOutput;
     }
     
     return framesToOutput;
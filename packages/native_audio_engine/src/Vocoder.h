@@ -1,15 +1,26 @@
 #ifndef VOCODER_H
 #define VOCODER_H
 
-#include "kiss_fft.h"
+#include "kiss_fftr.h"
 #include <vector>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <memory>
 #include <mutex>
 
 class Vocoder {
 public:
-    Vocoder(int sampleRate, int channels);
+    static constexpr int kDefaultFftSize = 2048;
+    static constexpr int kDefaultOverlap = 4; // 75%
+    static constexpr int kMinFftSize = 256;
+    static constexpr int kMaxFftSize = 16384;
+
+    // fftSize is rounded up to a power of two in [kMinFftSize, kMaxFftSize],
+    // overlap (frames per fftSize, hop = fftSize / overlap) to one in [4, 16].
+    // Smaller frames react faster and cost less per hop (rhythmic material),
+    // larger ones resolve low notes better (sustained piano).
+    Vocoder(int sampleRate, int channels, int fftSize = kDefaultFftSize, int overlap = kDefaultOverlap);
     ~Vocoder();
 
     void setTempo(float speed);
@@ -18,11 +29,17 @@ public:
     // Ingest stereo interleaved samples. 
     // Internally buffers them.
     void putSamples(const float* stereoInput, int numFrames);
+    // Feeds a frame of silence so everything put so far comes out.
+    void flush();
 
     // Retrieve processed stereo interleaved samples.
     // Returns the actual number of frames retrieved (up to maxFrames).
     int receiveSamples(float* stereoOutput, int maxFrames);
 
+    int numSamples();            // output frames ready to receive
+    int numUnprocessedSamples(); // input frames not yet past an analysis hop
+    int frameSize() const { return _fftSize; }
+
 private:
     int _sampleRate;
     int _channels;
@@ -30,22 +47,50 @@ private:
     
     // Core parameters
     int _fftSize;
-    int _hopSizeIn;
+    int _overlap;
+    int _hopSizeIn;     // analysis hop just taken (whole samples)
     int _hopSizeOut;
+    double _hopCarry;   // fraction of a sample the analysis hops are behind
     
-    // KissFFT states
-    kiss_fft_cfg _fftCfg;
-    kiss_fft_cfg _ifftCfg;
+    // Real-input KissFFT states: the input is real, so only bins 0..N/2 are
+    // computed and processed. Plan and window come from a process-wide cache
+    // keyed by size (see Vocoder.cpp).
+    struct FftPlan;
+    struct PlanCache;
+    FftPlan* _plan;
+    std::shared_ptr<const std::vector<float>> _window; // Hann, analysis and synthesis
+    int _numBins; // N/2 + 1
     
+    // FIFO of one channel's samples. Power-of-two capacity fixed at
+    // construction; positions are running counts. Only grows if a caller
+    // queues more output than it holds without receiving.
+    struct SampleRing {
+        std::vector<float> data;
+        size_t mask = 0;
+        uint64_t readPos = 0;
+        uint64_t writePos = 0;
+
+        void init(size_t capacity);
+        void grow(size_t capacity); // keeps the queued samples
+        size_t size() const { return static_cast<size_t>(writePos - readPos); }
+        size_t space() const { return data.size() - size(); }
+        float& at(uint64_t pos) { return data[pos & mask]; }
+        // Copies `count` samples from readPos + offset without consuming them.
+        void peek(float* out, size_t offset, size_t count) const;
+        void clear() { readPos = writePos = 0; }
+    };
+
     // Buffers per channel
     struct ChannelState {
-        std::vector<float> inputBuffer;
-        std::vector<float> outputBuffer;
+        SampleRing input;
+        SampleRing output;
+        // Overlap-add accumulator, circular: slots outside
+        // [overlapPos, overlapPos + fftSize) are always zero.
         std::vector<float> overlapBuffer;
+        size_t overlapMask;
+        uint64_t overlapPos;
         std::vector<float> lastPhase;
         std::vector<float> sumPhase;
-        std::vector<float> analysisWindow;
-        std::vector<float> synthesisWindow;
         std::vector<float> magCache;
         std::vector<float> phaseCache;
         float lastEnergy;
@@ -55,11 +100,12 @@ private:
     };
     
     std::vector<ChannelState> _ch;
-    std::vector<kiss_fft_cpx> _fftIn;
-    std::vector<kiss_fft_cpx> _fftOut;
+    std::vector<float> _frame;           // windowed frame in, resynthesized frame out
+    std::vector<kiss_fft_cpx> _spectrum; // _numBins bins
     
     std::mutex _mutex;
 
+    void _put(const float* input, int numFrames); // nullptr puts silence
     void _processChannel(int chIdx);
     void _updateHopSizes();
 };
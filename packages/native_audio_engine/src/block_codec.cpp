@@ -0,0 +1,246 @@
+#include "block_codec.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const int kMethodVerbatim = 4;
+static const int kMaxOrder = 3;
+static const int kMaxRiceParam = 30;
+static const float kInt16ToFloat = 1.0f / 32768.0f;
+
+static inline uint32_t zigzag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u) {
+    return static_cast<int32_t>(u >> 1) ^ -static_cast<int32_t>(u & 1);
+}
+
+static inline int countLeadingZeros(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return 63 - static_cast<int>(index);
+#else
+    return __builtin_clzll(v);
+#endif
+}
+
+// Fixed polynomial predictors, as in FLAC.
+static inline int32_t predict(const int32_t* x, int i, int order) {
+    switch (order) {
+        case 1: return x[i - 1];
+        case 2: return 2 * x[i - 1] - x[i - 2];
+        case 3: return 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3];
+        default: return 0;
+    }
+}
+
+// --- BIT I/O (MSB first) ---
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : _out(out) {}
+
+    void write(uint32_t value, int bits) {
+        if (bits == 0) return;
+        _acc = (_acc << bits) | (value & ((1ull << bits) - 1));
+        _bits += bits;
+        while (_bits >= 8) {
+            _bits -= 8;
+            _out.push_back(static_cast<uint8_t>(_acc >> _bits));
+        }
+    }
+
+    // q zeros terminated by a one
+    void writeUnary(uint32_t q) {
+        while (q >= 32) {
+            write(0, 32);
+            q -= 32;
+        }
+        write(1, static_cast<int>(q) + 1);
+    }
+
+    void flush() {
+        if (_bits > 0) write(0, 8 - _bits);
+    }
+
+private:
+    std::vector<uint8_t>& _out;
+    uint64_t _acc = 0;
+    int _bits = 0;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const uint8_t* in) : _p(in) {}
+
+    uint32_t read(int bits) {
+        if (bits == 0) return 0;
+        refill();
+        uint32_t value = static_cast<uint32_t>(_buf >> (64 - bits));
+        _buf <<= bits;
+        _bits -= bits;
+        return value;
+    }
+
+    uint32_t readUnary() {
+        uint32_t q = 0;
+        for (;;) {
+            refill();
+            if (_buf == 0) {
+                // every buffered bit is a zero
+                q += _bits;
+                _bits = 0;
+                continue;
+            }
+            int zeros = countLeadingZeros(_buf);
+            q += zeros;
+            _buf <<= zeros + 1;
+            _bits -= zeros + 1;
+            return q;
+        }
+    }
+
+private:
+    // Keeps at least 49 bits buffered; never shifts by 64.
+    void refill() {
+        while (_bits <= 48) {
+            _buf |= static_cast<uint64_t>(*_p++) << (56 - _bits);
+            _bits += 8;
+        }
+    }
+
+    const uint8_t* _p;
+    uint64_t _buf = 0;
+    int _bits = 0;
+};
+
+// --- ENCODER ---
+
+static uint64_t riceBits(const std::vector<uint32_t>& residuals, int k) {
+    uint64_t bits = 0;
+    for (uint32_t u : residuals) {
+        bits += (u >> k) + 1 + k;
+    }
+    return bits;
+}
+
+static void encodeChannel(const int32_t* x, int frames, BitWriter& writer, std::vector<uint32_t>& residuals) {
+    // Pick the predictor order with the smallest residual magnitude
+    int bestOrder = 0;
+    uint64_t bestSum = UINT64_MAX;
+    int maxOrder = frames < kMaxOrder ? frames : kMaxOrder;
+    for (int order = 0; order <= maxOrder; order++) {
+        uint64_t sum = 0;
+        for (int i = order; i < frames; i++) {
+            sum += zigzag(x[i] - predict(x, i, order));
+        }
+        if (sum < bestSum) {
+            bestSum = sum;
+            bestOrder = order;
+        }
+    }
+
+    residuals.clear();
+    for (int i = bestOrder; i < frames; i++) {
+        residuals.push_back(zigzag(x[i] - predict(x, i, bestOrder)));
+    }
+
+    // Rice parameter ~ log2(mean residual); refine against the neighbours
+    uint64_t count = residuals.size();
+    int k = 0;
+    while (k < kMaxRiceParam && count > 0 && (count << (k + 1)) <= bestSum) k++;
+    int bestK = k;
+    uint64_t bestBits = riceBits(residuals, k);
+    for (int candidate = k - 1; candidate <= k + 1; candidate += 2) {
+        if (candidate < 0 || candidate > kMaxRiceParam) continue;
+        uint64_t bits = riceBits(residuals, candidate);
+        if (bits < bestBits) {
+            bestBits = bits;
+            bestK = candidate;
+        }
+    }
+
+    // Noise-like content can lose to plain samples
+    uint64_t codedBits = 8 + static_cast<uint64_t>(bestOrder) * 16 + bestBits;
+    if (codedBits >= 3 + static_cast<uint64_t>(frames) * 16) {
+        writer.write(kMethodVerbatim, 3);
+        for (int i = 0; i < frames; i++) {
+            writer.write(static_cast<uint16_t>(x[i]), 16);
+        }
+        return;
+    }
+
+    writer.write(static_cast<uint32_t>(bestOrder), 3);
+    writer.write(static_cast<uint32_t>(bestK), 5);
+    for (int i = 0; i < bestOrder; i++) {
+        writer.write(static_cast<uint16_t>(x[i]), 16);
+    }
+    for (uint32_t u : residuals) {
+        writer.writeUnary(u >> bestK);
+        writer.write(u, bestK);
+    }
+}
+
+void block_codec_encode(const int16_t* in, int frames, int channels, std::vector<uint8_t>& out) {
+    BitWriter writer(out);
+    std::vector<int32_t> x(frames);
+    std::vector<uint32_t> residuals;
+    residuals.reserve(frames);
+
+    for (int c = 0; c < channels; c++) {
+        for (int i = 0; i < frames; i++) {
+            x[i] = in[i * channels + c];
+        }
+        encodeChannel(x.data(), frames, writer, residuals);
+    }
+    writer.flush();
+}
+
+// --- DECODER ---
+
+void block_codec_decode(const uint8_t* in, int frames, int channels, float* out) {
+    BitReader reader(in);
+
+    for (int c = 0; c < channels; c++) {
+        float* dst = out + c;
+        int method = static_cast<int>(reader.read(3));
+
+        if (method == kMethodVerbatim) {
+            for (int i = 0; i < frames; i++) {
+                dst[i * channels] = static_cast<int16_t>(reader.read(16)) * kInt16ToFloat;
+            }
+            continue;
+        }
+
+        int k = static_cast<int>(reader.read(5));
+        int order = method;
+        // Predictor history in registers; x1 is the most recent sample
+        int32_t x1 = 0, x2 = 0, x3 = 0;
+        for (int i = 0; i < order && i < frames; i++) {
+            int32_t s = static_cast<int16_t>(reader.read(16));
+            x3 = x2;
+            x2 = x1;
+            x1 = s;
+            dst[i * channels] = s * kInt16ToFloat;
+        }
+
+        for (int i = order; i < frames; i++) {
+            uint32_t u = (reader.readUnary() << k) | reader.read(k);
+            int32_t prediction;
+            switch (order) {
+                case 1: prediction = x1; break;
+                case 2: prediction = 2 * x1 - x2; break;
+                case 3: prediction = 3 * x1 - 3 * x2 + x3; break;
+                default: prediction = 0; break;
+            }
+            int32_t s = prediction + unzigzag(u);
+            x3 = x2;
+            x2 = x1;
+            x1 = s;
+            dst[i * channels] = s * kInt16ToFloat;
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- LOSSLESS BLOCK CODEC ---
+// Compact in-memory format for 16-bit PCM stems, in the spirit of FLAC's
+// "fixed" subframes: every channel of a block is predicted with a polynomial
+// of order 0..3 and the residuals are Rice coded. Blocks are independent and
+// byte aligned, so any block can be decoded on its own around the playhead.
+//
+// Per channel and block:
+//   3 bits  method (0..3 = predictor order, 4 = verbatim 16-bit samples)
+//   5 bits  Rice parameter k (absent for verbatim)
+//   order x 16 bits warm-up samples, then one Rice code per remaining sample
+//
+// Quiet, mostly mono instrument stems typically shrink 3-5x versus float.
+
+// Appends one encoded block of `frames` interleaved frames to `out`.
+void block_codec_encode(const int16_t* in, int frames, int channels, std::vector<uint8_t>& out);
+
+// Decodes one block into interleaved floats in [-1, 1).
+// `in` must be followed by at least 8 readable bytes (the encoder's caller pads).
+void block_codec_decode(const uint8_t* in, int frames, int channels, float* out);
+
+#endif // BLOCK_CODEC_H
@@ -1,407 +1,3064 @@
 #include <iostream>
+#include <thread>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#else
+#include <sys/resource.h>
+#endif
 
 #define MINIAUDIO_IMPLEMENTATION
 #include "live_mixer.h"
-#include "soundtouch_wrapper.h"
+#include "mix_kernels.h"
+#include "resampler.h"
 
 using namespace std;
 
-// Forward declaration of callback wrapper
-void data_callback_wrapper(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+// Frames decoded per ma_decoder_read_pcm_frames call / progress report.
+static const ma_uint64 kDecodeChunkFrames = 16384;
+// Silent input after which a stretcher is known to hold only silence: SoundTouch
+// buffers one sequence + seek window + overlap, the Vocoder about two frames,
+// well under this for any of our profiles.
+static const float kStretchTailSeconds = 0.5f;
+// Offline export: the lead-in fed (and dropped) before the first frame, so it
+// starts exactly there, and how often progress is reported. Stretched exports
+// are rendered on every core in segments of kRenderSegmentSeconds, joined by
+// a crossfade that may shift up to kRenderSeamSearchSeconds to line them up.
+static const double kRenderLeadInSeconds = 0.1;
+static const int64_t kRenderProgressFrames = 65536;
+static const double kRenderSegmentSeconds = 10.0;
+static const double kRenderSpliceSeconds = 0.01;
+static const double kRenderSeamSearchSeconds = 0.005;
+// Seek pre-roll: the stretchers start this far before the target so the first
+// audible frame comes out of a settled WSOLA, stretching at most this many
+// chunks per block until the target is reached.
+static const double kSeekPrerollSeconds = 0.1;
+static const int kSeekPrimeChunks = 4;
+// A clock that stopped updating (device gone) is not extrapolated further than this.
+static const double kMaxClockExtrapolationSeconds = 0.25;
+// Rendered-loop cache: how long the mix must stay put before a loop is
+// rendered, the longest pass kept (memory: 60 s is ~23 MB at 48 kHz) and the
+// crossfade that makes the pass wrap seamlessly.
+static const int kLoopCacheSettleMs = 400;
+static const double kMaxLoopCacheSeconds = 60.0;
+static const double kLoopCacheSpliceSeconds = 0.01;
+// Pre-stretched stems: settle time as above, how often the thread looks at the
+// playhead while a window is being filled, output frames rendered per stem
+// between watermark updates, the lead-in fed before the anchor (covers the
+// stretcher's start-up), the crossfade at a loop wrap, and how far the
+// playhead may run ahead of the renderer before the window moves to it.
+static const int kPreStretchSettleMs = 400;
+static const int kPreStretchPollMs = 50;
+static const int64_t kPreStretchBlockFrames = 8192;
+static const double kPreStretchLeadInSeconds = 0.5;
+static const double kPreStretchSpliceSeconds = 0.01;
+static const double kPreStretchMaxBehindSeconds = 2.0;
+
+static int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LiveMixer::data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
     auto mixer = static_cast<LiveMixer*>(pDevice->pUserData);
     if (mixer) {
-        mixer->process(static_cast<float*>(pOutput), frameCount);
+        mixer->_measureCallback(static_cast<int>(frameCount));
+        if (mixer->_renderRing) {
+            mixer->_playFromRing(static_cast<float*>(pOutput), static_cast<int>(frameCount));
+        } else {
+            mixer->process(static_cast<float*>(pOutput), frameCount);
+        }
     }
 }
 
-LiveMixer::LiveMixer() {
-    // Initialize SoundTouch
-    _soundTouch = soundtouch_create();
-    soundtouch_setSampleRate(_soundTouch, 44100);
-    soundtouch_setChannels(_soundTouch, 2);
-    soundtouch_setTempo(_soundTouch, 1.0f);
-    
-    _mixBuffer.resize(1024 * 2); // default capacity
+LiveMixer::LiveMixer(const DeviceProfile& profile) {
+    _mixBuffer.resize(kMaxChunkFrames * 2 * kMaxStretchGroups);
+    _reserveBlockFrames(kDefaultBlockFrames);
+    mix_dither_init(&_dither, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)));
+
+    for (int g = 0; g < kMaxStretchGroups; g++) {
+        for (int i = 0; i < kNumSoundTouchSettings; i++) {
+            _groupSettings[g][i] = kNoPendingSetting;
+            _groups[g].pendingSettings[i].store(kNoPendingSetting, std::memory_order_relaxed);
+        }
+    }
+    _trackList.store(new TrackList(), std::memory_order_release);
+
+    // Device native rate: no resampling in the callback
+    if (_openDevice(profile, 0)) {
+        _sampleRate = static_cast<int>(_device.sampleRate);
+    }
+    _prefetchFrames = static_cast<int64_t>(_sampleRate) * 2;
+
+    // Stretchers of group 0, more groups are added on demand
+    _createStretchers(0);
+}
+
+static const struct {
+    int id;
+    ma_backend backend;
+} kBackends[] = {
+    {kDeviceBackendAAudio, ma_backend_aaudio},
+    {kDeviceBackendOpenSL, ma_backend_opensl},
+    {kDeviceBackendPulseAudio, ma_backend_pulseaudio},
+    {kDeviceBackendAlsa, ma_backend_alsa},
+    {kDeviceBackendWasapi, ma_backend_wasapi},
+    {kDeviceBackendNull, ma_backend_null},
+};
+
+static bool toMaBackend(int id, ma_backend* out) {
+    for (const auto& entry : kBackends) {
+        if (entry.id == id) {
+            *out = entry.backend;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int fromMaBackend(ma_backend backend) {
+    for (const auto& entry : kBackends) {
+        if (entry.backend == backend) return entry.id;
+    }
+    return kDeviceBackendAuto;
+}
 
-    // initialize miniaudio
+// Opens (but doesn't start) the playback device. Each preference the system
+// can't honour (backend, exclusive mode) is dropped in turn before giving up.
+bool LiveMixer::_openDevice(const DeviceProfile& profile, int sampleRate) {
     ma_device_config config = ma_device_config_init(ma_device_type_playback);
     config.playback.format   = ma_format_f32;
     config.playback.channels = 2; // Stereo
-    config.sampleRate        = 44100; // Fixed for now, or settable?
+    config.sampleRate        = static_cast<ma_uint32>(sampleRate);
+    config.periodSizeInFrames       = static_cast<ma_uint32>(std::max(0, profile.periodSizeInFrames));
+    config.periodSizeInMilliseconds = static_cast<ma_uint32>(std::max(0, profile.periodSizeInMilliseconds));
+    config.periods                  = static_cast<ma_uint32>(std::max(0, profile.periods));
+    config.performanceProfile = profile.lowLatency ? ma_performance_profile_low_latency : ma_performance_profile_conservative;
+    config.playback.shareMode = profile.exclusive ? ma_share_mode_exclusive : ma_share_mode_shared;
+    config.dataCallback      = data_callback;
+    config.pUserData         = this;
+
+    ma_backend backend;
+    if (profile.backend != kDeviceBackendAuto) {
+        if (!toMaBackend(profile.backend, &backend)) {
+            std::cerr << "Unknown audio backend " << profile.backend << ", using the default." << std::endl;
+        } else if (ma_context_init(&backend, 1, NULL, &_context) == MA_SUCCESS) {
+            _contextInit = true;
+        } else {
+            std::cerr << "Audio backend " << ma_get_backend_name(backend) << " unavailable, using the default." << std::endl;
+        }
+    }
+
+    for (;;) {
+        if (ma_device_init(_contextInit ? &_context : NULL, &config, &_device) == MA_SUCCESS) {
+            _deviceInit = true;
+            break;
+        }
+        if (config.playback.shareMode == ma_share_mode_exclusive) {
+            std::cerr << "Exclusive mode refused, retrying shared." << std::endl;
+            config.playback.shareMode = ma_share_mode_shared;
+        } else if (_contextInit) {
+            std::cerr << "Failed to open the device on the requested backend, retrying the default." << std::endl;
+            ma_context_uninit(&_context);
+            _contextInit = false;
+        } else {
+            std::cerr << "Failed to initialize playback device." << std::endl;
+            return false;
+        }
+    }
+
+    _deviceBufferSeconds = static_cast<double>(_device.playback.internalPeriodSizeInFrames) * _device.playback.internalPeriods /
+                           std::max<ma_uint32>(1, _device.playback.internalSampleRate);
+    // Internal sizes are at the backend's rate, which differs from ours only
+    // when a reopen landed on a device running at another rate.
+    _devicePeriodFrames = static_cast<int>(std::lround(static_cast<double>(_device.playback.internalPeriodSizeInFrames) *
+                                                       _device.sampleRate / std::max<ma_uint32>(1, _device.playback.internalSampleRate)));
+    _devicePeriods = static_cast<int>(_device.playback.internalPeriods);
+    _maxCallbackFrames.store(0, std::memory_order_relaxed);
+    _underruns.store(0, std::memory_order_relaxed);
+    _callbackClockReset.store(true, std::memory_order_relaxed);
+    _reserveBlockFrames(std::max(_devicePeriodFrames, static_cast<int>(kRenderBlockFrames)));
+    return true;
+}
+
+// Control thread (or the constructor), with neither the callback nor the
+// render thread running: the buffers only grow.
+void LiveMixer::_reserveBlockFrames(int frames) {
+    if (frames <= _blockFrames) return;
+    _blockFrames = frames;
+    for (StretchGroup& group : _groups) {
+        group.output.resize(static_cast<size_t>(frames) * 2);
+    }
+    _wrapBlock.resize(static_cast<size_t>(frames) * 2);
+    _switchBlock.resize(static_cast<size_t>(frames) * 2);
+}
+
+void LiveMixer::_closeDevice() {
+    if (_deviceInit) {
+        ma_device_uninit(&_device);
+        _deviceInit = false;
+    }
+    if (_contextInit) {
+        ma_context_uninit(&_context);
+        _contextInit = false;
+    }
+    _devicePeriodFrames = 0;
+    _devicePeriods = 0;
+}
+
+bool LiveMixer::setDeviceProfile(const DeviceProfile& profile) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    _closeDevice(); // stops the callback, so the audio-thread timing state is ours
+    // The ring must stay deeper than the new period: resize it with the device
+    _stopRenderThread();
+    bool opened = _openDevice(profile, _sampleRate);
+    _startRenderThread(_renderAheadRequest);
+    if (!opened) return false;
+
+    if (_isPlaying.load(std::memory_order_acquire) && ma_device_start(&_device) != MA_SUCCESS) {
+        std::cerr << "Failed to start playback device." << std::endl;
+    }
+    return true;
+}
+
+// --- RENDER-AHEAD ---
+
+// Best effort: audio priority where the platform lets an app ask for it.
+static void raiseRenderThreadPriority() {
+#if defined(_WIN32)
+    bool raised = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#elif defined(__APPLE__)
+    bool raised = pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#else
+    bool raised = setpriority(PRIO_PROCESS, 0, -16) == 0; // Android's THREAD_PRIORITY_AUDIO
+#endif
+    if (!raised) {
+        std::cerr << "Render thread runs at normal priority." << std::endl;
+    }
+}
+
+void LiveMixer::setRenderAhead(int frames) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    // Switch with the callback stopped so it never sees half a mode change
+    if (_deviceInit) ma_device_stop(&_device);
+    _stopRenderThread();
+    _renderAheadRequest = std::max(0, frames);
+    _startRenderThread(_renderAheadRequest);
+
+    if (_deviceInit && _isPlaying.load(std::memory_order_acquire) && ma_device_start(&_device) != MA_SUCCESS) {
+        std::cerr << "Failed to start playback device." << std::endl;
+    }
+}
+
+// Caller holds _controlMutex with the device stopped (or gone) and no render
+// thread. Does nothing for 0 (render-ahead off).
+void LiveMixer::_startRenderThread(int frames) {
+    if (frames <= 0) return;
+    // A ring shallower than a device period would run dry every callback
+    _renderAheadFrames = std::max(frames, _devicePeriodFrames + kRenderBlockFrames);
+    _renderRing.reset(new SpscRing<float>(static_cast<size_t>(_renderAheadFrames + kRenderBlockFrames) * 2));
+    _ringDiscard.store(0, std::memory_order_relaxed);
+    _ringPrimed = false;
+    _outputEnvelope = 0.0f;
+    _renderRunning.store(true, std::memory_order_release);
+    _renderThread = std::thread(&LiveMixer::_renderLoop, this);
+}
+
+// Caller holds _controlMutex with the device stopped (or gone).
+void LiveMixer::_stopRenderThread() {
+    _renderRunning.store(false, std::memory_order_release);
+    if (_renderThread.joinable()) _renderThread.join();
+    _renderRing.reset();
+    _renderAheadFrames = 0;
+}
+
+// Keeps the ring _renderAheadFrames deep while playing. Polls instead of
+// waiting on a condition so the callback never has to signal (no syscalls
+// on the audio thread).
+void LiveMixer::_renderLoop() {
+    raiseRenderThreadPriority();
+    std::vector<float> block(kRenderBlockFrames * 2);
+    const auto idle = std::chrono::microseconds(static_cast<int64_t>(kRenderBlockFrames * 500000.0 / _sampleRate));
+
+    while (_renderRunning.load(std::memory_order_acquire)) {
+        size_t queued = _renderRing->readable() / 2;
+        if (!_isPlaying.load(std::memory_order_acquire) || queued + kRenderBlockFrames > static_cast<size_t>(_renderAheadFrames)) {
+            std::this_thread::sleep_for(idle);
+            continue;
+        }
+
+        uint64_t blockStart = _renderRing->writePosition();
+        _seekApplied = false;
+        process(block.data(), kRenderBlockFrames);
+        if (_seekApplied) {
+            // Everything queued before this block belongs to the old position
+            _ringDiscard.store(blockStart, std::memory_order_release);
+        }
+        _renderRing->write(block.data(), block.size());
+    }
+}
+
+// Device callback in render-ahead mode: copy, fade, nothing else.
+void LiveMixer::_playFromRing(float* output, int numFrames) {
+    _renderRing->skipTo(_ringDiscard.load(std::memory_order_acquire));
+    if (_outputResume.exchange(false, std::memory_order_acquire)) {
+        _outputEnvelope = 0.0f;
+        _ringPrimed = false;
+    }
+
+    int got = static_cast<int>(_renderRing->read(output, static_cast<size_t>(numFrames) * 2) / 2);
+    if (got < numFrames) {
+        memset(output + got * 2, 0, (numFrames - got) * 2 * sizeof(float));
+        if (_ringPrimed) {
+            _underruns.fetch_add(1, std::memory_order_relaxed);
+            _outputEnvelope = 0.0f; // fade back in rather than click
+        }
+    } else {
+        _ringPrimed = true;
+    }
+
+    float step = 1.0f / (_sampleRate * 0.02f);
+    _outputEnvelope = mix_apply_envelope(output, numFrames, _outputEnvelope, 1.0f, step);
+}
+
+bool LiveMixer::getDeviceInfo(DeviceInfo* info) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    if (!info) return false;
+    *info = DeviceInfo();
+    info->sampleRate = _sampleRate;
+    if (!_deviceInit) return false;
+
+    int period = _devicePeriodFrames;
+    int periods = _devicePeriods;
+    int maxCallback = _maxCallbackFrames.load(std::memory_order_relaxed);
+
+    info->backend = fromMaBackend(_device.pContext->backend);
+    info->periodSizeInFrames = period;
+    info->periods = periods;
+    info->exclusive = _device.playback.shareMode == ma_share_mode_exclusive ? 1 : 0;
+    info->maxCallbackFrames = maxCallback;
+    // A full device buffer sits between process() and the speaker. Some backends
+    // pull bigger blocks than they negotiated; then those blocks set the depth.
+    info->outputLatencyFrames = std::max(period, maxCallback) * std::max(1, periods);
+    info->underruns = _underruns.load(std::memory_order_relaxed);
+    return true;
+}
+
+// A gap between callbacks longer than the whole device buffer means the
+// device ran dry in between: an audible dropout.
+void LiveMixer::_measureCallback(int frameCount) {
+    int64_t now = monotonicNanos();
+    if (_callbackClockReset.exchange(false, std::memory_order_acquire)) {
+        _lastCallbackNanos = 0;
+    }
+    if (_lastCallbackNanos != 0 && (now - _lastCallbackNanos) * 1e-9 > _deviceBufferSeconds) {
+        _underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    _lastCallbackNanos = now;
+
+    if (frameCount > _maxCallbackFrames.load(std::memory_order_relaxed)) {
+        _maxCallbackFrames.store(frameCount, std::memory_order_relaxed);
+    }
+}
+
+int LiveMixer::getSampleRate() {
+    return _sampleRate;
+}
+
+// Copies a whole track into a mixer-owned buffer at `outRate`.
+static OwnedTrackStorage* resampleTrack(const float* data, int64_t numSamples, int channels, int inRate, int outRate) {
+    int64_t inFrames = numSamples / channels;
+    Resampler resampler(inRate, outRate, channels);
+    OwnedTrackStorage* storage = OwnedTrackStorage::allocate(Resampler::outputLength(inFrames, inRate, outRate) * channels, channels);
+    if (!storage) return nullptr;
+
+    int64_t written = resampler.process(data, inFrames, storage->writableData());
+    resampler.flush(storage->writableData() + written * channels);
+    return storage;
+}
+
+LiveMixer::~LiveMixer() {
+    _closeDevice();
+    _stopRenderThread();
+
+    // Abort a loop render in progress, then drop the cache
+    _mixGeneration.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(_loopCacheMutex);
+        _loopCacheStopping = true;
+    }
+    _loopCacheWake.notify_all();
+    if (_loopCacheThread.joinable()) _loopCacheThread.join();
+    _publishLoopCache(nullptr);
+
+    // Same for the pre-stretched stems
+    _stretchGeneration.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(_preStretchMutex);
+        _preStretchStopping = true;
+    }
+    _preStretchWake.notify_all();
+    if (_preStretchThread.joinable()) _preStretchThread.join();
+    _clearPreStretch();
+
+    // Abort exports; their snapshots keep the tracks they read alive
+    {
+        std::lock_guard<std::mutex> lock(_renderJobsMutex);
+        for (auto& job : _renderJobs) {
+            job->cancelled.store(true, std::memory_order_release);
+        }
+        for (auto& job : _renderJobs) {
+            if (job->thread.joinable()) job->thread.join();
+        }
+    }
     
-    // NATIVE BUFFER TUNING FOR ANDROID UNDERRUNS
-    config.periodSizeInMilliseconds = 20; // 20ms period to give SoundTouch breathing room
-    config.periods = 3; // triple buffering for safety
+    // Stop pending decodes before tearing down the tracks they report to
+    {
+        std::lock_guard<std::mutex> lock(_controlMutex);
+        for (Track* track : _trackTable) {
+            if (track && track->load) track->load->cancelled.store(true, std::memory_order_release);
+        }
+    }
+    _loaders.reset();
+
+    _stretchWorkers.reset();
+    for (StretchGroup& group : _groups) {
+        for (auto& stretcher : group.stretchers) stretcher.reset();
+        delete group.pendingVocoder.exchange(nullptr);
+        delete group.retiredVocoder.exchange(nullptr);
+    }
+
+    // Cleanup tracks
+    for (Track* track : _trackTable) {
+        delete track;
+    }
+    _trackTable.clear();
+    _trackHandles.clear();
+    delete _trackList.exchange(nullptr);
+}
+
+
+void LiveMixer::startPlayback() {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    // The device stops right after _isPlaying clears, so process() rarely
+    // sees a stopped block: ask for the fade-in explicitly.
+    _fadeInPending.store(true, std::memory_order_release);
+    _isPlaying.store(true, std::memory_order_release);
+    _callbackClockReset.store(true, std::memory_order_release); // the stopped gap isn't an underrun
+    _clockResume.store(true, std::memory_order_release);
+    _outputResume.store(true, std::memory_order_release);
     
-    config.dataCallback      = data_callback_wrapper;
-    config.pUserData         = this;
+    if (_deviceInit) {
+        if (ma_device_start(&_device) != MA_SUCCESS) {
+            std::cerr << "Failed to start playback device." << std::endl;
+        }
+    }
+}
+
+void LiveMixer::stopPlayback() {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    _isPlaying.store(false, std::memory_order_release);
+    
+    if (_deviceInit) {
+        ma_device_stop(&_device);
+    }
+}
+
+int64_t LiveMixer::getAtomicPosition() {
+    return _atomicFramesWritten.load(std::memory_order_acquire);
+}
+
+bool LiveMixer::getPlaybackClock(PlaybackClock* clock) {
+    if (!clock) return false;
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    _clockBuffer.read(_clock);
+    *clock = _clock;
+
+    int64_t now = monotonicNanos();
+    int64_t pendingSeek = _pendingSeek.load(std::memory_order_acquire);
+    if (pendingSeek != kNoPendingSeek) {
+        // Not applied yet (e.g. paused): report the target
+        clock->position = pendingSeek;
+        clock->framesPerSecond = 0.0;
+    } else if (!_isPlaying.load(std::memory_order_acquire)) {
+        clock->framesPerSecond = 0.0;
+    } else if (clock->framesPerSecond > 0.0) {
+        double elapsed = std::min((now - clock->timestampNanos) * 1e-9, kMaxClockExtrapolationSeconds);
+        int64_t position = clock->position + static_cast<int64_t>(std::max(0.0, elapsed) * clock->framesPerSecond);
+        if (clock->loopEnd > clock->loopStart && position >= clock->loopEnd) {
+            position = clock->loopStart + (position - clock->loopStart) % (clock->loopEnd - clock->loopStart);
+        }
+        clock->position = position;
+    }
+    clock->timestampNanos = now;
+    return true;
+}
+
+int64_t LiveMixer::getAudiblePosition() {
+    PlaybackClock clock;
+    return getPlaybackClock(&clock) ? clock.position : 0;
+}
+
+bool LiveMixer::isStalled() {
+    return _isPlaying.load(std::memory_order_acquire) && _stalled.load(std::memory_order_relaxed);
+}
+
+// Builds a fresh TrackList from _trackTable and swaps it in.
+// The previous list (and the retired track, if any) are freed once the audio
+// thread is guaranteed not to hold them. Caller must hold _controlMutex.
+void LiveMixer::_publishTrackList(Track* retired) {
+    TrackList* next = new TrackList();
+    next->tracks.reserve(_trackTable.size());
+    for (Track* track : _trackTable) {
+        if (track && track->committed) next->tracks.push_back(track);
+    }
+
+    TrackList* prev = _trackList.exchange(next, std::memory_order_seq_cst);
+    _stretchChanged();
+
+    // The audio thread raises _audioBusy before loading _trackList, so once we
+    // observe it low after the exchange it can only ever pick up `next`.
+    // Worst case this waits one audio period.
+    while (_audioBusy.load(std::memory_order_seq_cst)) {
+        std::this_thread::yield();
+    }
+
+    delete prev;
+    delete retired;
+}
+
+LiveMixer::Track* LiveMixer::_trackForHandle(int handle) {
+    if (handle < 0 || handle >= static_cast<int>(_trackTable.size())) return nullptr;
+    return _trackTable[handle];
+}
+
+int LiveMixer::addTrack(const char* id, const float* data, int numSamples, int channels, int sampleRate) {
+    if (!id || !data || numSamples <= 0 || channels <= 0 || sampleRate < 0) return kInvalidHandle;
+
+    // Copy outside the lock, the audio thread never sees this track until published.
+    OwnedTrackStorage* storage;
+    if (sampleRate != 0 && sampleRate != _sampleRate) {
+        storage = resampleTrack(data, numSamples, channels, sampleRate, _sampleRate);
+    } else {
+        storage = OwnedTrackStorage::allocate(numSamples, channels);
+        if (storage) memcpy(storage->writableData(), data, static_cast<size_t>(numSamples) * sizeof(float));
+    }
+    if (!storage) return kInvalidHandle;
+    storage->buildActivity();
+
+    Track* track = new Track();
+    track->storage.reset(storage);
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    return _insertTrack(id, track);
+}
+
+int LiveMixer::createTrack(const char* id, int64_t numSamples, int channels) {
+    if (!id || numSamples <= 0 || channels <= 0) return kInvalidHandle;
+
+    OwnedTrackStorage* storage = OwnedTrackStorage::allocate(numSamples, channels);
+    if (!storage) {
+        std::cerr << "LiveMixer: could not allocate " << numSamples << " samples for " << id << std::endl;
+        return kInvalidHandle;
+    }
+
+    Track* track = new Track();
+    track->fillBuffer = storage->writableData();
+    track->storage.reset(storage);
+    track->committed = false;
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    return _insertTrack(id, track);
+}
+
+float* LiveMixer::getTrackBuffer(int handle) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    return track ? track->fillBuffer : nullptr;
+}
+
+bool LiveMixer::commitTrack(int handle) {
+    std::shared_ptr<TrackStorage> storage;
+    {
+        std::lock_guard<std::mutex> lock(_controlMutex);
+        Track* track = _trackForHandle(handle);
+        if (!track || track->committed || !track->fillBuffer) return false;
+
+        // After this the buffer belongs to the mixer, no more writes.
+        track->fillBuffer = nullptr;
+        storage = track->storage;
+    }
+
+    // Scanning a long track takes a while, keep it outside the lock
+    storage->buildActivity();
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track || track->storage != storage) return false; // removed or replaced meanwhile
+    track->committed = true;
+    _publishTrackList(nullptr);
+    return true;
+}
+
+int LiveMixer::adoptTrack(const char* id, float* data, int64_t numSamples, int channels, TrackReleaseFn release, void* context) {
+    if (!id || !data || numSamples <= 0 || channels <= 0) return kInvalidHandle;
+
+    Track* track = new Track();
+    track->storage.reset(new AdoptedTrackStorage(data, numSamples, channels, release, context));
+    track->storage->buildActivity();
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    return _insertTrack(id, track);
+}
+
+int LiveMixer::mapTrackFile(const char* id, const char* path, int channels) {
+    if (!id || !path) return kInvalidHandle;
+
+    MappedTrackStorage* storage = MappedTrackStorage::open(path, channels);
+    if (!storage) return kInvalidHandle;
+
+    if (storage->sampleRate() != 0 && storage->sampleRate() != _sampleRate) {
+        std::cerr << "LiveMixer: " << path << " is " << storage->sampleRate() << " Hz, resampling into memory" << std::endl;
+        OwnedTrackStorage* converted = resampleTrack(storage->data(), storage->numSamples(), storage->channels(),
+                                                     storage->sampleRate(), _sampleRate);
+        delete storage;
+        if (!converted) return kInvalidHandle;
+        converted->buildActivity();
+
+        Track* track = new Track();
+        track->storage.reset(converted);
+        std::lock_guard<std::mutex> lock(_controlMutex);
+        return _insertTrack(id, track);
+    }
+
+    Track* track = new Track();
+    track->storage.reset(storage);
+    // Fault in the opening seconds now rather than on the first audio block
+    storage->prefetch(0, _prefetchFrames);
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    return _insertTrack(id, track);
+}
+
+int LiveMixer::addCompressedTrack(const char* id, const float* data, int64_t numSamples, int channels, int codec, int sampleRate) {
+    if (codec == kTrackCodecFloat32) {
+        if (numSamples > INT32_MAX) return kInvalidHandle;
+        return addTrack(id, data, static_cast<int>(numSamples), channels, sampleRate);
+    }
+    if (!id || !data || numSamples <= 0 || channels <= 0 || sampleRate < 0) return kInvalidHandle;
+
+    // Resampling and encoding are the expensive parts, keep them outside the lock
+    std::unique_ptr<OwnedTrackStorage> converted;
+    if (sampleRate != 0 && sampleRate != _sampleRate) {
+        converted.reset(resampleTrack(data, numSamples, channels, sampleRate, _sampleRate));
+        if (!converted) return kInvalidHandle;
+        data = converted->data();
+        numSamples = converted->numSamples();
+    }
+    CompressedTrackStorage* storage = CompressedTrackStorage::encode(data, numSamples, channels, static_cast<TrackCodec>(codec));
+    if (!storage) {
+        std::cerr << "LiveMixer: unsupported codec " << codec << " for " << id << std::endl;
+        return kInvalidHandle;
+    }
+
+    Track* track = new Track();
+    track->storage.reset(storage);
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    return _insertTrack(id, track);
+}
+
+// --- NATIVE FILE LOADING ---
+
+int LiveMixer::addTrackFromFile(const char* id, const char* path, TrackLoadProgressFn progress, void* context) {
+    if (!id || !path) return kInvalidHandle;
+
+    TrackLoadSource source;
+    source.path = path;
+    source.progress = progress;
+    source.progressContext = context;
+    return _beginTrackLoad(id, source);
+}
+
+int LiveMixer::addTrackFromMemory(const char* id, const void* data, size_t size, TrackReleaseFn release, void* releaseContext,
+                                  TrackLoadProgressFn progress, void* context) {
+    if (!id || !data || size == 0) return kInvalidHandle;
+
+    TrackLoadSource source;
+    source.data = data;
+    source.size = size;
+    source.release = release;
+    source.releaseContext = releaseContext;
+    source.progress = progress;
+    source.progressContext = context;
+    return _beginTrackLoad(id, source);
+}
+
+// Registers an empty, uncommitted track and queues its decode.
+// On failure the source memory stays with the caller.
+int LiveMixer::_beginTrackLoad(const char* id, const TrackLoadSource& source) {
+    Track* track = new Track();
+    track->committed = false;
+    track->load = std::make_shared<TrackLoad>();
+    std::shared_ptr<TrackLoad> load = track->load;
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    int handle = _insertTrack(id, track);
+    if (handle == kInvalidHandle) return kInvalidHandle;
+
+    if (!_loaders) {
+        _loaders.reset(new WorkerPool(WorkerPool::defaultThreadCount()));
+    }
+    _loaders->submit([this, handle, load, source]() {
+        _decodeTrack(handle, load, source);
+    });
+    return handle;
+}
+
+// Loader thread: decode the file into a mixer-owned buffer. When the length is
+// known up front the track is published straight away and plays up to the
+// decode watermark (progressive playback); otherwise it is published once done.
+void LiveMixer::_decodeTrack(int handle, std::shared_ptr<TrackLoad> load, const TrackLoadSource& source) {
+    auto report = [&](int64_t decoded, int64_t total) {
+        if (source.progress) source.progress(source.progressContext, handle, decoded, total);
+    };
+    auto fail = [&]() {
+        load->state.store(kTrackLoadFailed, std::memory_order_release);
+        _stretchChanged();
+        report(-1, load->totalFrames.load(std::memory_order_relaxed));
+    };
+
+    // Decode to float at the file's own rate and channel count; other rates go
+    // through the polyphase resampler (ma_decoder's own is linear only)
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 0, 0);
+    ma_decoder decoder;
+    ma_result result = source.path.empty()
+        ? ma_decoder_init_memory(source.data, source.size, &config, &decoder)
+        : ma_decoder_init_file(source.path.c_str(), &config, &decoder);
+
+    if (result != MA_SUCCESS || load->cancelled.load(std::memory_order_acquire)) {
+        if (result == MA_SUCCESS) ma_decoder_uninit(&decoder);
+        else std::cerr << "LiveMixer: cannot decode track " << handle << " (" << result << ")" << std::endl;
+        if (source.release) source.release(source.releaseContext);
+        fail();
+        return;
+    }
+
+    int channels = static_cast<int>(decoder.outputChannels);
+    int fileRate = static_cast<int>(decoder.outputSampleRate);
+    std::unique_ptr<Resampler> resampler;
+    if (fileRate != _sampleRate) resampler.reset(new Resampler(fileRate, _sampleRate, channels));
+
+    ma_uint64 sourceLength = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &sourceLength) != MA_SUCCESS) sourceLength = 0;
+    int64_t length = static_cast<int64_t>(sourceLength);
+    if (resampler) length = Resampler::outputLength(length, fileRate, _sampleRate);
+    load->totalFrames.store(length, std::memory_order_relaxed);
+
+    std::shared_ptr<OwnedTrackStorage> storage;
+    std::vector<float> pending; // only when the length isn't known up front
+    std::vector<float> chunk;   // decoder output at the file rate, when resampling
+    bool ok = true;
+    if (length > 0) {
+        storage.reset(OwnedTrackStorage::allocate(length * channels, channels));
+        if (storage) storage->resetActivity();
+        ok = storage && _publishTrackLoad(handle, load, storage, kTrackLoadStreaming);
+    }
+
+    int64_t read = 0;    // frames at the file rate
+    int64_t decoded = 0; // frames at the mixer rate
+    int64_t scanned = 0; // frames covered by the activity map, published to the audio thread
+
+    // Room for `frames` more output frames. The storage is sized for the whole
+    // file, so it never needs to grow.
+    auto reserve = [&](int64_t frames) -> float* {
+        if (storage) return storage->writableData() + decoded * channels;
+        pending.resize(static_cast<size_t>(decoded + frames) * channels);
+        return pending.data() + decoded * channels;
+    };
+    // Advances the watermark over whole activity blocks (all of it at the end),
+    // so the audio thread never reads a block the map hasn't covered yet.
+    auto publish = [&](bool last) {
+        if (!storage) {
+            load->decodedFrames.store(decoded, std::memory_order_release);
+            return;
+        }
+        int64_t upTo = last ? decoded : decoded / TrackStorage::kActivityBlockFrames * TrackStorage::kActivityBlockFrames;
+        if (upTo > scanned) {
+            storage->scanActivity(storage->data() + scanned * channels, scanned, upTo - scanned);
+            scanned = upTo;
+        }
+        load->decodedFrames.store(scanned, std::memory_order_release);
+    };
+
+    while (ok && !load->cancelled.load(std::memory_order_acquire)) {
+        ma_uint64 want = kDecodeChunkFrames;
+        if (sourceLength > 0) {
+            if (static_cast<ma_uint64>(read) >= sourceLength) break;
+            want = std::min<ma_uint64>(want, sourceLength - read);
+        }
+        float* dst;
+        if (resampler) {
+            chunk.resize(static_cast<size_t>(want) * channels);
+            dst = chunk.data();
+        } else {
+            dst = reserve(static_cast<int64_t>(want));
+        }
+
+        ma_uint64 got = 0;
+        result = ma_decoder_read_pcm_frames(&decoder, dst, want, &got);
+        read += static_cast<int64_t>(got);
+        bool last = got < want || result != MA_SUCCESS || (sourceLength > 0 && static_cast<ma_uint64>(read) >= sourceLength);
+
+        if (resampler) {
+            int64_t frames = static_cast<int64_t>(got);
+            decoded += resampler->process(chunk.data(), frames, reserve(resampler->maxOutput(frames)));
+            if (last) decoded += resampler->flush(reserve(resampler->maxOutput(0)));
+        } else {
+            decoded += static_cast<int64_t>(got);
+        }
+
+        publish(last);
+        if (last) break;
+        report(decoded, length);
+    }
+
+    ma_decoder_uninit(&decoder);
+    if (source.release) source.release(source.releaseContext);
+
+    if (!ok || decoded == 0 || load->cancelled.load(std::memory_order_acquire)) {
+        fail();
+        return;
+    }
+
+    // A short decode keeps the announced buffer; the watermark bounds playback.
+    load->totalFrames.store(decoded, std::memory_order_relaxed);
+    if (!storage) {
+        storage.reset(OwnedTrackStorage::allocate(decoded * channels, channels));
+        if (!storage) {
+            fail();
+            return;
+        }
+        memcpy(storage->writableData(), pending.data(), static_cast<size_t>(decoded) * channels * sizeof(float));
+        storage->buildActivity();
+        if (!_publishTrackLoad(handle, load, storage, kTrackLoadReady)) {
+            fail();
+            return;
+        }
+    }
+    load->state.store(kTrackLoadReady, std::memory_order_release);
+    _stretchChanged();
+    report(decoded, decoded);
+}
+
+// Loader thread: attach the decode buffer and publish the track, unless it was
+// removed or replaced meanwhile. The loader keeps its own reference to
+// `storage`, so it can keep writing past the watermark even if the track goes away.
+bool LiveMixer::_publishTrackLoad(int handle, const std::shared_ptr<TrackLoad>& load,
+                                  const std::shared_ptr<OwnedTrackStorage>& storage, int state) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track || track->load != load || load->cancelled.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    track->storage = storage;
+    track->committed = true;
+    load->state.store(state, std::memory_order_release);
+    _publishTrackList(nullptr);
+    return true;
+}
+
+int LiveMixer::getTrackLoadState(int handle, int64_t* decodedFrames, int64_t* totalFrames) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track) return kTrackLoadFailed;
+
+    if (!track->load) {
+        int64_t frames = track->storage ? track->storage->frames() : 0;
+        if (decodedFrames) *decodedFrames = frames;
+        if (totalFrames) *totalFrames = frames;
+        return kTrackLoadReady;
+    }
+    if (decodedFrames) *decodedFrames = track->load->decodedFrames.load(std::memory_order_acquire);
+    if (totalFrames) *totalFrames = track->load->totalFrames.load(std::memory_order_acquire);
+    return track->load->state.load(std::memory_order_acquire);
+}
+
+bool LiveMixer::getTrackInfo(int handle, int64_t* frames, int* channels) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track || !track->storage) return false;
+    // While streaming this is the announced length, not the watermark
+    int64_t length = track->storage->frames();
+    if (track->load && track->load->state.load(std::memory_order_acquire) == kTrackLoadReady) {
+        length = std::min(length, track->load->decodedFrames.load(std::memory_order_acquire));
+    }
+    if (frames) *frames = length;
+    if (channels) *channels = track->storage->channels();
+    return true;
+}
+
+int LiveMixer::getTrackPeaks(int handle, int channel, float* out, int points) {
+    if (!out || points <= 0) return 0;
+
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track || !track->storage || !track->storage->data()) return 0;
+
+    const TrackStorage* storage = track->storage.get();
+    int channels = storage->channels();
+    int64_t frames = storage->frames();
+    if (channel < 0 || channel >= channels || frames == 0) return 0;
+
+    // Never read past the decode watermark of a streaming track
+    int64_t readable = frames;
+    if (track->load) {
+        readable = std::min(readable, track->load->decodedFrames.load(std::memory_order_acquire));
+    }
+
+    const float* data = storage->data();
+    for (int p = 0; p < points; p++) {
+        int64_t start = frames * p / points;
+        int64_t end = std::min(frames * (p + 1) / points, readable);
+        float peak = 0.0f;
+        for (int64_t i = start; i < end; i++) {
+            float v = std::fabs(data[i * channels + channel]);
+            if (v > peak) peak = v;
+        }
+        out[p] = peak;
+    }
+    return points;
+}
+
+// Registers `track` under `id` and publishes it if committed.
+// Caller must hold _controlMutex. Takes ownership of `track` in all cases.
+int LiveMixer::_insertTrack(const char* id, Track* track) {
+    track->paged = track->storage && track->storage->wantsPrefetch();
+
+    // Check if exists: keep the handle, swap the audio
+    auto it = _trackHandles.find(id);
+    if (it != _trackHandles.end()) {
+        int handle = it->second;
+        Track* replaced = _trackTable[handle];
+        _trackTable[handle] = track;
+        _publishTrackList(replaced);
+        return handle;
+    }
+
+    // Lowest free slot keeps the table (and the published list) dense
+    int handle = kInvalidHandle;
+    for (int i = 0; i < static_cast<int>(_trackTable.size()); i++) {
+        if (!_trackTable[i]) {
+            handle = i;
+            break;
+        }
+    }
+    if (handle == kInvalidHandle) {
+        if (static_cast<int>(_trackTable.size()) >= kMaxTracks) {
+            std::cerr << "LiveMixer: track limit reached (" << kMaxTracks << ")" << std::endl;
+            delete track;
+            return kInvalidHandle;
+        }
+        handle = static_cast<int>(_trackTable.size());
+        _trackTable.push_back(nullptr);
+    }
+
+    _trackTable[handle] = track;
+    _trackHandles[id] = handle;
+    if (track->committed) {
+        _publishTrackList(nullptr);
+    }
+    return handle;
+}
+
+int LiveMixer::getTrackHandle(const char* id) {
+    if (!id) return kInvalidHandle;
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    auto it = _trackHandles.find(id);
+    return it != _trackHandles.end() ? it->second : kInvalidHandle;
+}
+
+void LiveMixer::removeTrack(int handle) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track) return;
+
+    _trackTable[handle] = nullptr;
+    for (auto it = _trackHandles.begin(); it != _trackHandles.end(); ++it) {
+        if (it->second == handle) {
+            _trackHandles.erase(it);
+            break;
+        }
+    }
+    _publishTrackList(track);
+}
+
+// Per-track setters only touch atomics, no lookup beyond an array index.
+void LiveMixer::setTrackVolume(int handle, float volume) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    if (Track* track = _trackForHandle(handle)) {
+        track->volume.store(volume, std::memory_order_relaxed);
+        _mixChanged();
+    }
+}
+
+void LiveMixer::setTrackPan(int handle, float pan) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    if (Track* track = _trackForHandle(handle)) {
+        track->pan.store(pan, std::memory_order_relaxed);
+        _mixChanged();
+    }
+}
+
+void LiveMixer::setTrackMute(int handle, bool muted) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    if (Track* track = _trackForHandle(handle)) {
+        track->muted.store(muted, std::memory_order_relaxed);
+        _mixChanged();
+    }
+}
+
+void LiveMixer::setTrackSolo(int handle, bool solo) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    if (Track* track = _trackForHandle(handle)) {
+        track->solo.store(solo, std::memory_order_relaxed);
+        _mixChanged();
+    }
+}
+
+// Control thread, under _controlMutex: creates groups up to `count`, configured
+// like the existing ones, before the audio thread may see them.
+void LiveMixer::_addStretchGroups(int count) {
+    int current = _numStretchGroups.load(std::memory_order_relaxed);
+    if (count <= current) return;
+
+    if (!_stretchWorkers) {
+        _stretchWorkers.reset(new BlockWorkers(std::min(kMaxStretchGroups - 1, WorkerPool::defaultThreadCount())));
+    }
+    for (int g = current; g < count; g++) {
+        _createStretchers(g);
+    }
+    _numStretchGroups.store(count, std::memory_order_release);
+    _stretchChanged();
+}
+
+// Control thread (or the constructor): one stretcher per engine, at the
+// current tempo and the group's settings, so any engine can take over
+// without allocating on the audio thread.
+void LiveMixer::_createStretchers(int g) {
+    for (int engine = 0; engine < kNumStretchEngines; engine++) {
+        _groups[g].stretchers[engine].reset(_newStretcher(engine, g));
+    }
+}
+
+TimeStretcher* LiveMixer::_newStretcher(int engine, int g) {
+    TimeStretcher* stretcher = TimeStretcher::create(engine, _sampleRate, 2, _groupFrames[g]);
+    if (!stretcher) return nullptr;
+    stretcher->setTempo(_controls.speed);
+    for (int i = 0; i < kNumSoundTouchSettings; i++) {
+        if (_groupSettings[g][i] != kNoPendingSetting) stretcher->setSetting(i, _groupSettings[g][i]);
+    }
+    return stretcher;
+}
+
+// Control thread, under _controlMutex: publishes a Vocoder stretcher with the
+// group's current frame. One the audio thread never took is freed here, and so
+// is the one it retired, before publishing (it retires at most one per
+// publication) and after (it may have taken the previous one meanwhile), so
+// the retired slot is always empty when the audio thread takes the new one.
+void LiveMixer::_replaceVocoder(int g) {
+    StretchGroup& group = _groups[g];
+    delete group.retiredVocoder.exchange(nullptr, std::memory_order_acq_rel);
+    delete group.pendingVocoder.exchange(_newStretcher(kStretchEngineVocoder, g), std::memory_order_acq_rel);
+    delete group.retiredVocoder.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+bool LiveMixer::setTrackStretchGroup(int handle, int group) {
+    if (group < 0 || group >= kMaxStretchGroups) return false;
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    Track* track = _trackForHandle(handle);
+    if (!track) return false;
+    _addStretchGroups(group + 1);
+    track->stretchGroup.store(group, std::memory_order_release);
+    _stretchChanged();
+    return true;
+}
+
+// Audio thread: called once per block with _activeTracks loaded.
+void LiveMixer::_updateAnySolo() {
+    _anySolo = false;
+    for (Track* track : _activeTracks->tracks) {
+        if (track->solo.load(std::memory_order_relaxed)) {
+            _anySolo = true;
+            break;
+        }
+    }
+}
+
+// Routing and gains of `track`; false if solo/mute silence it.
+bool LiveMixer::_voiceForTrack(Track* track, bool anySolo, MixVoice& voice) {
+    // Solo-in-place logic: 
+    // If any track is soloed, ONLY soloed tracks play (mute is ignored)
+    if (anySolo) {
+        if (!track->solo.load(std::memory_order_relaxed)) return false;
+    } else {
+        if (track->muted.load(std::memory_order_relaxed)) return false;
+    }
+
+    float pan = track->pan.load(std::memory_order_relaxed);
+    float volume = track->volume.load(std::memory_order_relaxed);
+    float lGain = 1.0f;
+    float rGain = 1.0f;
+    if (pan > 0) lGain = 1.0f - pan;
+    else if (pan < 0) rGain = 1.0f + pan;
+
+    TrackStorage* storage = track->storage.get();
+    voice.data = storage->data();
+    voice.source = storage;
+    voice.frames = storage->frames();
+    voice.peaks = storage->hasActivity() ? storage->blockPeaks() : nullptr;
+    voice.streaming = false;
+    if (TrackLoad* load = track->load.get()) {
+        // State first: once it reads ready the final watermark is visible too
+        voice.streaming = load->state.load(std::memory_order_acquire) == kTrackLoadStreaming;
+        voice.frames = std::min(voice.frames, load->decodedFrames.load(std::memory_order_acquire));
+    }
+    voice.channels = storage->channels();
+    voice.group = track->stretchGroup.load(std::memory_order_acquire);
+    voice.gainL = volume * lGain;
+    voice.gainR = volume * rGain;
+    return true;
+}
+
+// Audio thread: snapshot routing and gains of every audible track into _voices.
+void LiveMixer::_buildVoices() {
+    _numVoices = 0;
+    for (int g = 0; g < _activeGroups; g++) {
+        _groups[g].hasVoices = false;
+    }
+    for (Track* track : _activeTracks->tracks) {
+        MixVoice& voice = _voices[_numVoices];
+        if (!_voiceForTrack(track, _anySolo, voice)) continue;
+        // A group published after this block's snapshot plays in group 0 until the next one
+        if (voice.group >= _activeGroups) voice.group = 0;
+        _groups[voice.group].hasVoices = true;
+        _numVoices++;
+    }
+}
+
+// Audio thread: keep a window of _prefetchFrames ahead of the playhead resident
+// for memory-mapped tracks. Re-hints only when the playhead has consumed half the
+// window or jumped out of it (seek, loop wrap), so this is a syscall every
+// second or so per paged track, not one per block.
+void LiveMixer::_prefetchPagedTracks() {
+    for (Track* track : _activeTracks->tracks) {
+        if (!track->paged) continue;
+        if (_currentPosition >= track->prefetchFrom &&
+            _currentPosition + _prefetchFrames / 2 < track->prefetchUntil) {
+            continue;
+        }
+        track->storage->prefetch(_currentPosition, _prefetchFrames);
+        track->prefetchFrom = _currentPosition;
+        track->prefetchUntil = _currentPosition + _prefetchFrames;
+    }
+}
+
+void LiveMixer::setLoop(int64_t startSample, int64_t endSample, bool enabled) {
+    // A wrap jumps straight to the loop start, past the pre-roll handling of
+    // negative positions: keep the range inside the timeline
+    startSample = std::max<int64_t>(0, startSample);
+    endSample = std::max(endSample, startSample);
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    _controls.loopStart = startSample;
+    _controls.loopEnd = endSample;
+    _controls.loopEnabled = enabled;
+    _controlsBuffer.write(_controls);
+    if (enabled && !_loopCacheThread.joinable()) {
+        _loopCacheThread = std::thread(&LiveMixer::_loopCacheLoop, this);
+    }
+    _mixChanged();
+
+    // The loop start is where the playhead jumps back to on every wrap; warm it
+    // up from here so the audio thread never faults on it.
+    if (enabled && endSample > startSample) {
+        int64_t frames = std::min<int64_t>(endSample - startSample, _prefetchFrames);
+        for (Track* track : _trackTable) {
+            if (track && track->paged) track->storage->prefetch(startSample, frames);
+        }
+    }
+}
+
+void LiveMixer::seek(int64_t positionSample) {
+    if (positionSample < 0) positionSample = 0;
+    _pendingSeek.store(positionSample, std::memory_order_release);
+    
+    // Update UI shadow immediately, the audio thread confirms it next block
+    _atomicFramesWritten.store(positionSample, std::memory_order_release);
+}
+
+int64_t LiveMixer::getPosition() {
+    // This is the old locked getter. 
+    // We should implement new atomic getter.
+    return _atomicFramesWritten.load(std::memory_order_acquire); 
+    // Wait, I reused the variable name from header but confused logic.
+    // Header has `_atomicFramesWritten`. 
+    // Let's use THAT as the "File Position" shadow? No, that's confusing.
+    
+    // I will use `_atomicFramesWritten` to mean "Current File Position Atomic Shadow".
+    // In `process`, I will update it to match `_currentPosition`.
+}
+
+void LiveMixer::setSpeed(float speed) {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    _controls.speed = speed;
+    _controlsBuffer.write(_controls);
+    if (std::abs(speed - 1.0f) >= 0.001f && !_preStretchThread.joinable()) {
+        _preStretchThread = std::thread(&LiveMixer::_preStretchLoop, this);
+    }
+    _stretchChanged();
+}
+
+void LiveMixer::setStretchEngine(int engine) {
+    if (engine < 0 || engine >= kNumStretchEngines) return;
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    if (_controls.stretchEngine == engine) return;
+    _controls.stretchEngine = engine;
+    // Before publishing: the audio thread must not take a cache of the old
+    // engine for one rendered with the new one
+    _stretchChanged();
+    _controlsBuffer.write(_controls);
+}
+
+int LiveMixer::getStretchEngine() {
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    return _controls.stretchEngine;
+}
+
+void LiveMixer::setVocoderFrame(int fftSize, int overlap) {
+    for (int g = 0; g < kMaxStretchGroups; g++) {
+        setStretchGroupVocoderFrame(g, fftSize, overlap);
+    }
+}
+
+void LiveMixer::setSoundTouchSetting(int settingId, int value) {
+    if (settingId < 0 || settingId >= kNumSoundTouchSettings) return;
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    for (int g = 0; g < kMaxStretchGroups; g++) {
+        _groupSettings[g][settingId] = value;
+    }
+    int groups = _numStretchGroups.load(std::memory_order_relaxed);
+    for (int g = 0; g < groups; g++) {
+        _groups[g].pendingSettings[settingId].store(value, std::memory_order_release);
+    }
+    _stretchChanged();
+}
+
+void LiveMixer::setStretchGroupSetting(int group, int settingId, int value) {
+    if (settingId < 0 || settingId >= kNumSoundTouchSettings) return;
+    if (group < 0 || group >= kMaxStretchGroups) return;
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    _addStretchGroups(group + 1);
+    _groupSettings[group][settingId] = value;
+    _groups[group].pendingSettings[settingId].store(value, std::memory_order_release);
+    _stretchChanged();
+}
+
+void LiveMixer::setStretchGroupVocoderFrame(int group, int fftSize, int overlap) {
+    if (group < 0 || group >= kMaxStretchGroups) return;
+    VocoderFrame frame;
+    frame.fftSize = std::max(0, fftSize);
+    frame.overlap = std::max(0, overlap);
+    std::lock_guard<std::mutex> lock(_controlMutex);
+    VocoderFrame& current = _groupFrames[group];
+    if (current.fftSize == frame.fftSize && current.overlap == frame.overlap) return;
+    current = frame;
+    // Groups yet to exist are created with it; the others get a new stretcher
+    if (group < _numStretchGroups.load(std::memory_order_relaxed)) {
+        _replaceVocoder(group);
+    }
+    _stretchChanged();
+}
+
+// Audio thread: apply everything the control thread published since the last block.
+void LiveMixer::_drainControls() {
+    int groups = _numStretchGroups.load(std::memory_order_acquire);
+    if (groups != _activeGroups) {
+        // A new group would start its stretch timeline here while the others
+        // still hold their backlog; restart them all together, fading in.
+        _activeGroups = groups;
+        _clearStretchers();
+        _masterEnvelope = 0.0f;
+    }
+    if (_fadeInPending.exchange(false, std::memory_order_acq_rel)) {
+        _masterEnvelope = 0.0f; // playback (re)started
+    }
+
+    Controls controls;
+    if (_controlsBuffer.read(controls)) {
+        if (controls.speed != _speed) {
+            _speed = controls.speed;
+            for (int g = 0; g < _activeGroups; g++) {
+                if (TimeStretcher* stretcher = _groups[g].stretchers[_engine].get()) stretcher->setTempo(_speed);
+            }
+            _rate = _engine == kStretchEngineBypass ? 1.0f : _speed;
+        }
+        _requestedEngine = controls.stretchEngine; // switched by process()
+
+        _loopStart = controls.loopStart;
+        _loopEnd = controls.loopEnd;
+        _loopEnabled = controls.loopEnabled;
+
+        // Safety clamp current position if needed
+        if (_loopEnabled && _loopEnd > _loopStart && _currentPosition >= _loopEnd) {
+            _currentPosition = _loopStart;
+        }
+    }
+
+    for (int g = 0; g < _activeGroups; g++) {
+        StretchGroup& group = _groups[g];
+        for (int i = 0; i < kNumSoundTouchSettings; i++) {
+            int value = group.pendingSettings[i].exchange(kNoPendingSetting, std::memory_order_acq_rel);
+            if (value != kNoPendingSetting) {
+                for (auto& stretcher : group.stretchers) {
+                    if (stretcher) stretcher->setSetting(i, value);
+                }
+            }
+        }
+        if (group.pendingVocoder.load(std::memory_order_acquire)) _vocoderPending = true;
+    }
+    // A Vocoder in use is replaced by process(), crossfaded; idle ones right away
+    if (_vocoderPending && _engine != kStretchEngineVocoder) _adoptVocoders();
+
+    int64_t seekTarget = _pendingSeek.exchange(kNoPendingSeek, std::memory_order_acq_rel);
+    if (seekTarget != kNoPendingSeek) {
+        _currentPosition = seekTarget;
+        _audiblePosition = seekTarget;
+        _positionFloor = seekTarget;
+        _seekApplied = true;
+        _outputSource = kOutputLive; // re-entered at the target if a cached source holds it
+
+        _clearStretchers();
+        if (std::abs(_rate - 1.0f) >= 0.001f) {
+            _primeStretchers(seekTarget, false);
+        }
+
+        // Clear any temporary buffers
+        std::fill(_mixBuffer.begin(), _mixBuffer.end(), 0.0f);
+
+        // Reset envelope to 0 for a quick 20ms fade-in of the new audio 
+        // to prevent any pops from non-zero crossings
+        _masterEnvelope = 0.0f;
+    }
+
+    _updateAnySolo();
+    _buildVoices();
+    _prefetchPagedTracks();
+}
+
+void LiveMixer::_clearStretchers() {
+    for (int g = 0; g < _activeGroups; g++) {
+        StretchGroup& group = _groups[g];
+        if (TimeStretcher* stretcher = group.stretchers[_engine].get()) stretcher->clear();
+        group.silentFrames = 0;
+        group.idleSilence = 0.0;
+        group.discard = 0;
+    }
+    if (_seekTarget >= 0) {
+        // A seek's pre-roll cut short: carry on from its target
+        _currentPosition = _seekTarget;
+        _seekTarget = -1;
+    }
+}
+
+// Audio thread, after a seek has cleared the stretchers: mix from
+// kSeekPrerollSeconds before `target` (silence before the start of the song)
+// and have every group drop the output that plays before it, so the first
+// frame heard is the target with WSOLA already in its stride. `inFull` primes
+// within the next block instead of a few chunks per block.
+void LiveMixer::_primeStretchers(int64_t target, bool inFull) {
+    int64_t preroll = static_cast<int64_t>(_sampleRate * kSeekPrerollSeconds);
+    _currentPosition = target - preroll;
+    _seekTarget = target;
+    _primeInFull = inFull;
+    for (int g = 0; g < _activeGroups; g++) {
+        double lead = _groups[g].stretchers[_engine]->startLead(_speed);
+        _groups[g].discard = std::max<int64_t>(0, std::llround((preroll - lead) / _speed));
+    }
+}
+
+// Audio thread: hands the live path over to _requestedEngine. The old engine
+// renders one more block into _switchBlock, to be faded out against the new
+// one; the new stretchers start over at the frame that block starts with,
+// primed in full (warmed up) so that they have audio for this very block.
+// Returns whether _switchBlock holds that continuation.
+bool LiveMixer::_switchEngine(int numFrames, bool playing) {
+    int64_t length = _loopEnd - _loopStart;
+    int64_t heard = _seekTarget >= 0 ? _seekTarget : _currentPosition - static_cast<int64_t>(_stretchBacklog());
+    if (_loopEnabled && length > 0 && heard < _loopStart && _currentPosition >= _loopStart) heard += length;
+
+    bool faded = false;
+    if (playing && _outputSource == kOutputLive) {
+        faded = !_renderLive(_switchBlock.data(), numFrames, std::abs(_rate - 1.0f) < 0.001f);
+    }
+
+    _adoptVocoders();
+    _engine = _requestedEngine;
+    _rate = _engine == kStretchEngineBypass ? 1.0f : _speed;
+    for (int g = 0; g < _activeGroups; g++) {
+        if (TimeStretcher* stretcher = _groups[g].stretchers[_engine].get()) stretcher->setTempo(_speed);
+    }
+    _seekTarget = -1;
+    _clearStretchers();
+    _currentPosition = heard;
+    if (std::abs(_rate - 1.0f) >= 0.001f) {
+        _primeStretchers(heard, true);
+    }
+    return faded;
+}
+
+// Audio thread: swaps in the Vocoder stretchers published by _replaceVocoder(),
+// at tempo _speed; the caller clears them (or they are fresh).
+void LiveMixer::_adoptVocoders() {
+    _vocoderPending = false;
+    for (int g = 0; g < _activeGroups; g++) {
+        StretchGroup& group = _groups[g];
+        if (group.retiredVocoder.load(std::memory_order_acquire)) continue;
+        TimeStretcher* fresh = group.pendingVocoder.exchange(nullptr, std::memory_order_acq_rel);
+        if (!fresh) continue;
+        fresh->setTempo(_speed);
+        group.retiredVocoder.store(group.stretchers[kStretchEngineVocoder].release(), std::memory_order_release);
+        group.stretchers[kStretchEngineVocoder].reset(fresh);
+    }
+}
+
+// Audio thread: moves what `group` can already deliver into its block of the
+// current process() call, silence owed by the idle fast path first. Seek
+// pre-roll is dropped (through the free part of the block) before anything.
+void LiveMixer::_drainStretchGroup(StretchGroup& group, float* output, int numFrames) {
+    TimeStretcher* stretcher = group.stretchers[_engine].get();
+    int needed = numFrames - group.received;
+    while (group.discard > 0 && needed > 0) {
+        int drop = static_cast<int>(std::min<int64_t>(group.discard, needed));
+        int got = stretcher->receiveSamples(output + group.received * 2, drop);
+        if (got <= 0) return;
+        group.discard -= got;
+    }
+    int owed = std::min(needed, static_cast<int>(group.idleSilence));
+    if (owed > 0) {
+        memset(output + group.received * 2, 0, owed * 2 * sizeof(float));
+        group.received += owed;
+        group.idleSilence -= owed;
+        needed -= owed;
+    }
+    if (needed > 0) {
+        group.received += stretcher->receiveSamples(output + group.received * 2, needed);
+    }
+}
+
+// Audio thread (or a stretch worker during process()): feeds the group's part
+// of the current chunk to its stretcher, unless both it and the chunk hold
+// nothing but silence: then skip the stretching and owe the stretched length
+// of zeros. The stretcher keeps its (silent) state, so audio resumes seamlessly.
+void LiveMixer::_feedStretchGroup(int g) {
+    StretchGroup& group = _groups[g];
+    int mixed = _chunkMixed;
+    if (mixed <= 0) return;
+
+    if (!group.audible && group.silentFrames >= static_cast<int64_t>(_sampleRate * kStretchTailSeconds)) {
+        group.idleSilence += mixed / static_cast<double>(_speed);
+    } else {
+        group.stretchers[_engine]->putSamples(_mixBuffer.data() + g * _chunkStride, mixed);
+        group.silentFrames = group.audible ? 0 : group.silentFrames + mixed;
+    }
+}
+
+void LiveMixer::feedStretchGroupJob(void* context, int group) {
+    static_cast<LiveMixer*>(context)->_feedStretchGroup(group);
+}
+
+// Accumulates one contiguous run of a voice into the stereo block.
+static inline void mixRun(float* out, const float* in, int frames, int channels, float gainL, float gainR) {
+    if (channels == 1) {
+        mix_mono_to_stereo(out, in, frames, gainL, gainR);
+    } else if (channels == 2) {
+        mix_stereo_to_stereo(out, in, frames, gainL, gainR);
+    } else {
+        mix_strided_to_stereo(out, in, frames, channels, gainL, gainR);
+    }
+}
+
+// Mixes frames [position, position + frames) of one voice into the stereo block.
+void LiveMixer::_mixVoiceRun(const MixVoice& voice, float* out, int64_t position, int frames) {
+    if (voice.data) {
+        mixRun(out, voice.data + position * voice.channels, frames, voice.channels, voice.gainL, voice.gainR);
+        return;
+    }
+
+    // Compressed track: one kernel call per decoded block touched
+    int mixed = 0;
+    while (mixed < frames) {
+        int64_t available = 0;
+        const float* in = voice.source->decodeAt(position + mixed, available);
+        if (!in || available <= 0) break;
+        int run = static_cast<int>(std::min<int64_t>(frames - mixed, available));
+        mixRun(out + mixed * 2, in, run, voice.channels, voice.gainL, voice.gainR);
+        mixed += run;
+    }
+}
+
+// Walk the activity map: mix only runs of audible blocks.
+bool LiveMixer::_mixVoice(const MixVoice& voice, float* out, int64_t position, int frames) {
+    bool audible = false;
+    int offset = 0;
+    while (offset < frames) {
+        int run = frames - offset;
+        if (voice.peaks) {
+            const int64_t blockFrames = TrackStorage::kActivityBlockFrames;
+            int64_t frame = position + offset;
+            int64_t block = frame / blockFrames;
+            bool active = voice.peaks[block] >= TrackStorage::kSilentPeak;
+            int64_t runEnd = (block + 1) * blockFrames;
+            int64_t end = position + frames;
+            while (runEnd < end && (voice.peaks[runEnd / blockFrames] >= TrackStorage::kSilentPeak) == active) {
+                runEnd += blockFrames;
+            }
+            run = static_cast<int>(std::min(runEnd, end) - frame);
+            if (!active) {
+                offset += run;
+                continue;
+            }
+        }
+        audible = true;
+        _mixVoiceRun(voice, out + offset * 2, position + offset, run);
+        offset += run;
+    }
+    return audible;
+}
+
+// Internal mixing logic (Raw audio from tracks)
+int LiveMixer::_mixInternal(float* outputBuffer, int numFrames, int groupStride) {
+    // Audio thread only. Assumes process() has loaded _activeTracks.
+    
+    // Clear buffer (silence)
+    int floats = groupStride > 0 ? groupStride * _activeGroups : numFrames * 2; // Stereo output
+    memset(outputBuffer, 0, floats * sizeof(float));
+    for (int g = 0; g < _activeGroups; g++) {
+        _groups[g].audible = false;
+    }
+
+    if (_activeTracks->tracks.empty()) {
+        _stalled.store(false, std::memory_order_relaxed);
+        return numFrames; 
+    }
+
+    // Seek pre-roll before the start of the song: silence
+    int done = 0;
+    if (_currentPosition < 0) {
+        done = static_cast<int>(std::min<int64_t>(numFrames, -_currentPosition));
+        _currentPosition += done;
+    }
+
+    // Progressive playback: never run ahead of a stem that is still decoding
+    int64_t watermark = INT64_MAX;
+    for (int v = 0; v < _numVoices; v++) {
+        if (_voices[v].streaming) watermark = std::min(watermark, _voices[v].frames);
+    }
+
+    // Block-oriented: split the request at loop boundaries, then give each voice
+    // one branch-free kernel call over the frames it actually has.
+    while (done < numFrames) {
+        // Handle Loop
+        bool looping = _loopEnabled && _loopEnd > _loopStart;
+        if (looping && _currentPosition >= _loopEnd) {
+            // WRAP CHECK: If we are AT or PAST the end, wrap!
+            _currentPosition = _loopStart;
+        }
+
+        int64_t segment = numFrames - done;
+        if (looping && _loopEnd - _currentPosition < segment) {
+            segment = _loopEnd - _currentPosition;
+        }
+        if (_currentPosition >= watermark) break; // stall, hold the position
+        segment = std::min(segment, watermark - _currentPosition);
+
+        for (int v = 0; v < _numVoices; v++) {
+            const MixVoice& voice = _voices[v];
+            float* out = outputBuffer + voice.group * groupStride + done * 2;
+            if (_currentPosition >= voice.frames) continue; // track ended
+            if (voice.gainL == 0.0f && voice.gainR == 0.0f) continue;
+
+            int frames = static_cast<int>(std::min<int64_t>(segment, voice.frames - _currentPosition));
+            if (_mixVoice(voice, out, _currentPosition, frames)) {
+                _groups[voice.group].audible = true;
+            }
+        }
+
+        done += static_cast<int>(segment);
+        _currentPosition += segment;
+    }
+
+    _stalled.store(done < numFrames, std::memory_order_relaxed);
+    return done;
+}
+
+// Source frames already mixed that the stretcher hasn't output yet: its input
+// queue, its output FIFO and any silence owed by the idle path, minus the
+// part it has already played ahead (see TimeStretcher::lead()).
+// With several stretch groups the first one that has voices stands for all.
+double LiveMixer::_stretchBacklog() {
+    // Cached sources map their frames straight to source positions
+    if (_outputSource != kOutputLive || std::abs(_rate - 1.0f) < 0.001f) return 0.0;
+
+    const StretchGroup* group = &_groups[0];
+    for (int g = 0; g < _activeGroups; g++) {
+        if (_groups[g].hasVoices) {
+            group = &_groups[g];
+            break;
+        }
+    }
+    TimeStretcher* stretcher = group->stretchers[_engine].get();
+    double queued = stretcher->numUnprocessedSamples() +
+                    (stretcher->numSamples() + group->idleSilence) * _speed;
+    return std::max(0.0, queued - stretcher->lead(_speed));
+}
+
+// Audio thread, end of a block: the device buffer (one full buffer after this
+// block) and the stretcher sit between _currentPosition and the speaker.
+void LiveMixer::_publishClock(int numFrames, bool playing) {
+    bool looping = _loopEnabled && _loopEnd > _loopStart;
+    if (playing) {
+        if (_clockResume.exchange(false, std::memory_order_acquire) && _positionFloor < 0) {
+            _positionFloor = _audiblePosition;
+        }
+        int64_t latency = _devicePeriods * std::max(_devicePeriodFrames, numFrames);
+        if (_renderRing) {
+            // Rendered ahead: the ring sits in front of the device buffer
+            latency = static_cast<int64_t>(_devicePeriods) * _devicePeriodFrames + _renderRing->readable() / 2 + numFrames;
+        }
+        double behind = _stretchBacklog() + static_cast<double>(latency) * _rate;
+        int64_t position = _currentPosition - static_cast<int64_t>(behind);
+        if (looping && _currentPosition >= _loopStart && position < _loopStart) {
+            int64_t length = _loopEnd - _loopStart;
+            position = _loopEnd - (_loopStart - position) % length;
+        }
+        position = std::max<int64_t>(0, position);
+
+        // After a seek or a restart the buffer still drains older audio; hold
+        // the target rather than report a position the user never asked for.
+        if (_positionFloor >= 0) {
+            if (position >= _positionFloor || (_currentPosition < _positionFloor && _seekTarget < 0)) {
+                _positionFloor = -1;
+            } else {
+                position = _positionFloor;
+            }
+        }
+        _audiblePosition = position;
+    }
+
+    PlaybackClock clock;
+    clock.position = _audiblePosition;
+    clock.timestampNanos = monotonicNanos();
+    bool moving = playing && !_stalled.load(std::memory_order_relaxed) && _seekTarget < 0;
+    clock.framesPerSecond = moving ? static_cast<double>(_rate) * _sampleRate : 0.0;
+    clock.loopStart = looping ? _loopStart : 0;
+    clock.loopEnd = looping ? _loopEnd : 0;
+    _clockBuffer.write(clock);
+}
+
+// --- OFFLINE RENDERING ---
+
+struct LiveMixer::MixSnapshot {
+    std::vector<MixVoice> voices;
+    std::vector<std::shared_ptr<TrackStorage>> storages; // keeps the voices' data alive
+    int groups = 1;
+    float speed = 1.0f; // 1 with kStretchEngineBypass
+    int engine = kStretchEngineSoundTouch;
+    int settings[kMaxStretchGroups][kNumSoundTouchSettings];
+    VocoderFrame frames[kMaxStretchGroups];
+};
+
+// Fails while a track is still decoding, or for compressed tracks: their
+// decodeAt() belongs to the audio thread.
+bool LiveMixer::_snapshotMix(MixSnapshot& snapshot) {
+    bool anySolo = false;
+    for (Track* track : _trackTable) {
+        if (track && track->committed && track->solo.load(std::memory_order_relaxed)) anySolo = true;
+    }
+    snapshot.groups = _numStretchGroups.load(std::memory_order_relaxed);
+    snapshot.engine = _controls.stretchEngine;
+    snapshot.speed = snapshot.engine == kStretchEngineBypass ? 1.0f : _controls.speed;
+    memcpy(snapshot.settings, _groupSettings, sizeof(_groupSettings));
+    std::copy(_groupFrames, _groupFrames + kMaxStretchGroups, snapshot.frames);
+
+    for (Track* track : _trackTable) {
+        if (!track || !track->committed) continue;
+        MixVoice voice;
+        if (!_voiceForTrack(track, anySolo, voice)) continue;
+        if (voice.streaming || !voice.data) return false;
+        if (voice.group >= snapshot.groups) voice.group = 0;
+        snapshot.voices.push_back(voice);
+        snapshot.storages.push_back(track->storage);
+    }
+    return true;
+}
+
+// Renders a MixSnapshot from `position` onwards the way process() would
+// (looping over [loopStart, loopEnd) unless that is empty, silence before
+// frame 0), with its own stretchers of the snapshot's engine. Allocates; never
+// for the audio thread.
+class LiveMixer::StretchRenderer {
+public:
+    StretchRenderer(const MixSnapshot& snapshot, int sampleRate, int64_t position, int64_t loopStart, int64_t loopEnd)
+        : _snapshot(snapshot), _sampleRate(sampleRate), _position(position), _loopStart(loopStart), _loopEnd(loopEnd) {
+        _stretching = std::abs(snapshot.speed - 1.0f) >= 0.001f;
+        for (const MixVoice& voice : snapshot.voices) {
+            _end = std::max(_end, voice.frames);
+        }
+        if (!_stretching) return;
+
+        for (int g = 0; g < snapshot.groups; g++) {
+            _stretchers[g].reset(TimeStretcher::create(snapshot.engine, sampleRate, 2, snapshot.frames[g]));
+            _stretchers[g]->setTempo(snapshot.speed);
+            for (int i = 0; i < kNumSoundTouchSettings; i++) {
+                if (snapshot.settings[g][i] != kNoPendingSetting) {
+                    _stretchers[g]->setSetting(i, snapshot.settings[g][i]);
+                }
+            }
+        }
+        _chunk.resize(kChunkFrames * 2 * snapshot.groups);
+    }
+
+    // Fills `output` (interleaved stereo) and returns the frames written; fewer
+    // than numFrames once the material has ended (never while looping).
+    int render(float* output, int numFrames) {
+        if (!_stretching) return _mix(output, numFrames, 0);
+
+        memset(output, 0, numFrames * 2 * sizeof(float));
+        if (_received.size() < static_cast<size_t>(numFrames) * 2) _received.resize(numFrames * 2);
+        int received[kMaxStretchGroups] = {};
+        for (;;) {
+            bool filled = true;
+            for (int g = 0; g < _snapshot.groups; g++) {
+                int got = _stretchers[g]->receiveSamples(_received.data(), numFrames - received[g]);
+                mix_stereo_to_stereo(output + received[g] * 2, _received.data(), got, 1.0f, 1.0f);
+                received[g] += got;
+                if (received[g] < numFrames) filled = false;
+            }
+            if (filled || _flushed) break;
+
+            // Same chunk of the timeline for every group, as in process()
+            int mixed = _mix(_chunk.data(), kChunkFrames, kChunkFrames * 2);
+            for (int g = 0; g < _snapshot.groups; g++) {
+                if (mixed > 0) _stretchers[g]->putSamples(_chunk.data() + g * kChunkFrames * 2, mixed);
+                if (mixed < kChunkFrames) _stretchers[g]->flush();
+            }
+            if (mixed < kChunkFrames) _flushed = true;
+        }
+        int produced = 0;
+        for (int g = 0; g < _snapshot.groups; g++) {
+            produced = std::max(produced, received[g]);
+        }
+        return produced;
+    }
+
+    // Source frames the output, counted from the first frame rendered, runs
+    // ahead of the nominal time map, for the first group with voices (see
+    // TimeStretcher::startLead()).
+    double lead() const {
+        if (!_stretching) return 0.0;
+        int group = _snapshot.voices.empty() ? 0 : _snapshot.voices[0].group;
+        for (const MixVoice& voice : _snapshot.voices) {
+            group = std::min(group, voice.group);
+        }
+        return _stretchers[group]->startLead(_snapshot.speed);
+    }
+
+private:
+    static constexpr int kChunkFrames = 1024;
+
+    // _mixInternal() for the snapshot: per group blocks `stride` floats apart,
+    // or all together with stride 0. Returns the frames mixed.
+    int _mix(float* buffer, int numFrames, int stride) {
+        memset(buffer, 0, (stride > 0 ? stride * _snapshot.groups : numFrames * 2) * sizeof(float));
+        bool looping = _loopEnd > _loopStart;
+        int done = 0;
+        while (done < numFrames) {
+            if (_position < 0) {
+                int silent = static_cast<int>(std::min<int64_t>(numFrames - done, -_position));
+                done += silent;
+                _position += silent;
+                continue;
+            }
+            if (looping && _position >= _loopEnd) _position = _loopStart;
+            int64_t segment = numFrames - done;
+            if (looping) segment = std::min(segment, _loopEnd - _position);
+            else if (_position >= _end) break;
+            else segment = std::min(segment, _end - _position);
+
+            for (const MixVoice& voice : _snapshot.voices) {
+                if (_position >= voice.frames) continue; // track ended
+                if (voice.gainL == 0.0f && voice.gainR == 0.0f) continue;
+                int frames = static_cast<int>(std::min<int64_t>(segment, voice.frames - _position));
+                _mixVoice(voice, buffer + voice.group * stride + done * 2, _position, frames);
+            }
+            done += static_cast<int>(segment);
+            _position += segment;
+        }
+        return done;
+    }
+
+    const MixSnapshot& _snapshot;
+    int _sampleRate;
+    bool _stretching = false;
+    int64_t _position;
+    int64_t _loopStart;
+    int64_t _loopEnd;
+    int64_t _end = 0; // longest voice
+    std::unique_ptr<TimeStretcher> _stretchers[kMaxStretchGroups];
+    std::vector<float> _chunk;
+    std::vector<float> _received;
+    bool _flushed = false;
+};
+
+// --- OFFLINE EXPORT ---
+
+int LiveMixer::renderToFile(const char* path, int format, int64_t startFrame, int64_t endFrame,
+                            RenderProgressFn progress, void* context) {
+    if (!path || format < kWavFormatPcm16 || format > kWavFormatFloat32) return kInvalidHandle;
+
+    std::shared_ptr<MixSnapshot> snapshot = std::make_shared<MixSnapshot>();
+    int64_t songFrames = 0;
+    int sampleRate;
+    {
+        std::lock_guard<std::mutex> lock(_controlMutex);
+        if (!_snapshotMix(*snapshot)) {
+            std::cerr << "LiveMixer: can't export while a track is decoding or compressed" << std::endl;
+            return kInvalidHandle;
+        }
+        // Muted tracks still count towards the length
+        for (Track* track : _trackTable) {
+            if (track && track->committed) songFrames = std::max(songFrames, track->storage->frames());
+        }
+        sampleRate = _sampleRate;
+    }
+    int64_t end = endFrame > 0 ? std::min(endFrame, songFrames) : songFrames;
+    startFrame = std::max<int64_t>(0, startFrame);
+    if (startFrame >= end) return kInvalidHandle;
+
+    WavWriter* writer = WavWriter::open(path, sampleRate, 2, static_cast<WavSampleFormat>(format));
+    if (!writer) {
+        std::cerr << "LiveMixer: can't create " << path << std::endl;
+        return kInvalidHandle;
+    }
+
+    std::lock_guard<std::mutex> lock(_renderJobsMutex);
+    for (auto& job : _renderJobs) {
+        if (job->thread.joinable() && job->state.load(std::memory_order_acquire) != kRenderRunning) job->thread.join();
+    }
+    _renderJobs.emplace_back(new RenderJob());
+    RenderJob* job = _renderJobs.back().get();
+    int id = static_cast<int>(_renderJobs.size());
+    job->totalFrames = std::llround((end - startFrame) / static_cast<double>(snapshot->speed));
+    job->sampleRate = sampleRate;
+    job->thread = std::thread(&LiveMixer::_renderJob, this, id, job, snapshot, std::string(path), writer,
+                              startFrame, progress, context);
+    return id;
+}
+
+int LiveMixer::getRenderState(int job, int64_t* framesWritten, int64_t* totalFrames) {
+    std::lock_guard<std::mutex> lock(_renderJobsMutex);
+    if (job < 1 || job > static_cast<int>(_renderJobs.size())) return kRenderFailed;
+    RenderJob* state = _renderJobs[job - 1].get();
+    if (framesWritten) *framesWritten = state->framesWritten.load(std::memory_order_acquire);
+    if (totalFrames) *totalFrames = state->totalFrames;
+    return state->state.load(std::memory_order_acquire);
+}
+
+void LiveMixer::cancelRender(int job) {
+    std::lock_guard<std::mutex> lock(_renderJobsMutex);
+    if (job < 1 || job > static_cast<int>(_renderJobs.size())) return;
+    _renderJobs[job - 1]->cancelled.store(true, std::memory_order_release);
+}
+
+// Export output from output frame `first` on, where frame 0 plays source
+// frame `startFrame`: fresh stretchers started a lead-in early and that part
+// dropped, silence once the material has ended.
+class LiveMixer::ExportStream {
+public:
+    ExportStream(const MixSnapshot& snapshot, int sampleRate, int64_t startFrame, int64_t first) {
+        double source = startFrame + first * static_cast<double>(snapshot.speed);
+        int64_t from = static_cast<int64_t>(std::floor(source)) - static_cast<int64_t>(sampleRate * kRenderLeadInSeconds);
+        _renderer.reset(new StretchRenderer(snapshot, sampleRate, from, 0, 0));
+        _skip = std::max<int64_t>(0, std::llround((source - from - _renderer->lead()) / snapshot.speed));
+    }
+
+    void read(float* output, int64_t numFrames) {
+        while (_skip > 0) {
+            if (_scratch.empty()) _scratch.resize(kBlockFrames * 2);
+            int n = static_cast<int>(std::min<int64_t>(_skip, kBlockFrames));
+            _renderer->render(_scratch.data(), n);
+            _skip -= n;
+        }
+        for (int64_t done = 0; done < numFrames;) {
+            int n = static_cast<int>(std::min<int64_t>(numFrames - done, kBlockFrames));
+            int got = _renderer->render(output + done * 2, n);
+            if (got < n) memset(output + (done + got) * 2, 0, (n - got) * 2 * sizeof(float));
+            done += n;
+        }
+    }
+
+    static constexpr int kBlockFrames = 4096;
+
+private:
+    std::unique_ptr<StretchRenderer> _renderer;
+    int64_t _skip = 0;
+    std::vector<float> _scratch;
+};
+
+// Render thread: one stream written block by block, or segments on every
+// core when there is stretching to spread.
+void LiveMixer::_renderJob(int job, RenderJob* state, std::shared_ptr<MixSnapshot> snapshot, std::string path,
+                           WavWriter* writer, int64_t startFrame, RenderProgressFn progress, void* context) {
+    std::unique_ptr<WavWriter> file(writer);
+    int64_t total = state->totalFrames;
+    std::function<void(int64_t)> report = [&](int64_t written) {
+        if (progress) progress(context, job, written, total);
+    };
+    auto cancelled = [&] { return state->cancelled.load(std::memory_order_acquire); };
+
+    bool stretching = std::abs(snapshot->speed - 1.0f) >= 0.001f;
+    bool parallel = stretching && std::thread::hardware_concurrency() > 1 &&
+                    total > static_cast<int64_t>(state->sampleRate * kRenderSegmentSeconds);
+    bool ok = true;
+    if (parallel) {
+        ok = _renderSegments(state, *snapshot, file.get(), startFrame, report);
+    } else {
+        ExportStream stream(*snapshot, state->sampleRate, startFrame, 0);
+        std::vector<float> block(ExportStream::kBlockFrames * 2);
+        int64_t written = 0;
+        while (ok && written < total && !cancelled()) {
+            int n = static_cast<int>(std::min<int64_t>(total - written, ExportStream::kBlockFrames));
+            stream.read(block.data(), n);
+            ok = file->write(block.data(), n);
+            written += n;
+            state->framesWritten.store(written, std::memory_order_release);
+            if (written % kRenderProgressFrames < n && written < total) report(written);
+        }
+    }
+
+    bool aborted = cancelled();
+    ok = ok && !aborted && file->finish();
+    file.reset();
+    if (!ok) {
+        std::remove(path.c_str());
+        if (!aborted) std::cerr << "LiveMixer: export to " << path << " failed" << std::endl;
+    }
+    state->state.store(ok ? kRenderDone : aborted ? kRenderCancelled : kRenderFailed, std::memory_order_release);
+    report(ok ? total : -1);
+}
+
+// Offset in [-range, range] at which `next` (interleaved stereo, indexed from
+// its nominal position) best continues `tail` over `overlap` frames: the
+// highest normalized cross-correlation of the channel sums, the smallest
+// shift on a tie (e.g. silence).
+static int seamOffset(const float* tail, const float* next, int overlap, int range) {
+    double best = 0.0;
+    int bestOffset = 0;
+    for (int step = 0; step <= 2 * range; step++) {
+        int offset = (step & 1) ? -(step + 1) / 2 : step / 2;
+        const float* candidate = next + offset * 2;
+        double dot = 0.0;
+        double energy = 0.0;
+        for (int i = 0; i < overlap; i++) {
+            float a = tail[i * 2] + tail[i * 2 + 1];
+            float b = candidate[i * 2] + candidate[i * 2 + 1];
+            dot += a * b;
+            energy += b * b;
+        }
+        double score = energy > 0.0 ? dot / std::sqrt(energy) : 0.0;
+        if (step == 0 || score > best) {
+            best = score;
+            bestOffset = offset;
+        }
+    }
+    return bestOffset;
+}
+
+// Stretched exports on a multi-core machine: segments of kRenderSegmentSeconds
+// of output are rendered on a pool with one thread per core, each with its own
+// stretchers from a little before its first frame to a little past its last.
+// This thread joins them in order with a short crossfade, shifted to where the
+// waveforms line up, and writes them out. A few segments beyond the one being
+// written are kept in flight. Returns false on a write error or cancellation.
+bool LiveMixer::_renderSegments(RenderJob* state, const MixSnapshot& snapshot, WavWriter* file, int64_t startFrame,
+                                const std::function<void(int64_t)>& report) {
+    int64_t total = state->totalFrames;
+    int64_t length = static_cast<int64_t>(state->sampleRate * kRenderSegmentSeconds);
+    int splice = static_cast<int>(state->sampleRate * kRenderSpliceSeconds);
+    int range = static_cast<int>(state->sampleRate * kRenderSeamSearchSeconds);
+    int64_t span = length + splice + 2 * range; // frames rendered per segment
+    int64_t segments = (total + length - 1) / length;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    std::vector<std::vector<float>> slots(static_cast<size_t>(std::min<int64_t>(threads + 2, segments)));
+    std::vector<char> rendered(slots.size(), 0);
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> failed{false};
+    auto stopped = [&] { return failed.load(std::memory_order_acquire) || state->cancelled.load(std::memory_order_acquire); };
+
+    // Declared after everything its jobs touch: its destructor drains the queue first
+    WorkerPool pool(threads);
+    auto submit = [&](int64_t segment) {
+        size_t slot = static_cast<size_t>(segment % slots.size());
+        pool.submit([&, segment, slot]() {
+            std::vector<float>& audio = slots[slot];
+            audio.resize(static_cast<size_t>(span) * 2);
+            ExportStream stream(snapshot, state->sampleRate, startFrame, segment * length - range);
+            for (int64_t done = 0; done < span && !stopped(); done += ExportStream::kBlockFrames) {
+                stream.read(audio.data() + done * 2, std::min<int64_t>(span - done, ExportStream::kBlockFrames));
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                rendered[slot] = 1;
+            }
+            wake.notify_all();
+        });
+    };
+
+    int64_t queued = 0;
+    while (queued < static_cast<int64_t>(slots.size())) submit(queued++);
+
+    std::vector<float> tail(static_cast<size_t>(splice) * 2);
+    int64_t written = 0;
+    for (int64_t segment = 0; segment < segments; segment++) {
+        size_t slot = static_cast<size_t>(segment % slots.size());
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return rendered[slot] != 0; });
+            rendered[slot] = 0;
+        }
+        if (stopped()) break;
+
+        float* audio = slots[slot].data() + range * 2; // the segment's nominal first frame
+        if (segment > 0) {
+            audio += seamOffset(tail.data(), audio, splice, range) * 2;
+            for (int i = 0; i < splice; i++) {
+                float w = (i + 0.5f) / splice;
+                audio[i * 2] = tail[i * 2] * (1.0f - w) + audio[i * 2] * w;
+                audio[i * 2 + 1] = tail[i * 2 + 1] * (1.0f - w) + audio[i * 2 + 1] * w;
+            }
+        }
+        int64_t frames = std::min(length, total - written);
+        if (!file->write(audio, frames)) {
+            failed.store(true, std::memory_order_release);
+            break;
+        }
+        memcpy(tail.data(), audio + length * 2, tail.size() * sizeof(float));
+        written += frames;
+        state->framesWritten.store(written, std::memory_order_release);
+        if (written < total) report(written);
+
+        if (queued < segments) submit(queued++);
+    }
+    return !stopped();
+}
+
+// --- RENDERED-LOOP CACHE ---
+
+// One pass of the stretched loop. Frame i plays source frame
+// loopStart + i * (loopEnd - loopStart) / frames, and the last frame runs
+// seamlessly into the first.
+struct LiveMixer::LoopCache {
+    uint64_t generation;
+    int64_t loopStart;
+    int64_t loopEnd;
+    float speed;
+    int engine;
+    int64_t frames;
+    std::vector<float> data; // interleaved stereo
+};
+
+void LiveMixer::setLoopCacheEnabled(bool enabled) {
+    _loopCacheEnabled.store(enabled, std::memory_order_release);
+    _mixChanged();
+}
+
+bool LiveMixer::isPlayingFromLoopCache() {
+    return _cachePlaying.load(std::memory_order_acquire);
+}
+
+// Any thread: whatever the loop sounds like has changed.
+void LiveMixer::_mixChanged() {
+    _mixGeneration.fetch_add(1, std::memory_order_acq_rel);
+    // Taking the mutex orders this against the cache thread's check-then-wait
+    { std::lock_guard<std::mutex> lock(_loopCacheMutex); }
+    _loopCacheWake.notify_one();
+}
+
+void LiveMixer::_loopCacheLoop() {
+    const auto settle = std::chrono::milliseconds(kLoopCacheSettleMs);
+    uint64_t handled = 0;
+    std::unique_lock<std::mutex> lock(_loopCacheMutex);
+    while (!_loopCacheStopping) {
+        uint64_t generation = _mixGeneration.load(std::memory_order_acquire);
+        if (generation == handled) {
+            _loopCacheWake.wait(lock);
+            continue;
+        }
+        // Wait until the mix stays put (a fader drag changes it every few ms)
+        bool changed = _loopCacheWake.wait_for(lock, settle, [&] {
+            return _loopCacheStopping || _mixGeneration.load(std::memory_order_acquire) != generation;
+        });
+        if (changed) continue;
+
+        handled = generation;
+        lock.unlock();
+        _renderLoopCache(generation);
+        lock.lock();
+    }
+}
+
+// Cache thread. Renders two passes' worth through fresh stretchers and keeps
+// the second, where the stretcher already carries the loop's own tail, starting
+// at the output frame that plays loopStart. A few ms past the pass are
+// crossfaded into its start, so it wraps without a seam.
+void LiveMixer::_renderLoopCache(uint64_t generation) {
+    MixSnapshot snapshot;
+    int64_t loopStart = 0;
+    int64_t loopEnd = 0;
+    bool cacheable;
+    {
+        std::lock_guard<std::mutex> lock(_controlMutex);
+        if (_mixGeneration.load(std::memory_order_acquire) != generation) return;
+        loopStart = _controls.loopStart;
+        loopEnd = _controls.loopEnd;
+        cacheable = _loopCacheEnabled.load(std::memory_order_acquire) &&
+                    _controls.loopEnabled && loopEnd > loopStart &&
+                    _snapshotMix(snapshot) &&
+                    std::abs(snapshot.speed - 1.0f) >= 0.001f; // 1x plays unstretched anyway
+    }
+    int64_t length = loopEnd - loopStart;
+    int64_t frames = cacheable ? std::llround(length / static_cast<double>(snapshot.speed)) : 0;
+    int64_t splice = std::min<int64_t>(static_cast<int64_t>(_sampleRate * kLoopCacheSpliceSeconds), frames / 4);
+    if (!cacheable || frames > _sampleRate * kMaxLoopCacheSeconds || splice < 1) {
+        _publishLoopCache(nullptr);
+        return;
+    }
+
+    auto stale = [&] { return _mixGeneration.load(std::memory_order_acquire) != generation; };
+    StretchRenderer renderer(snapshot, _sampleRate, loopStart, loopStart, loopEnd);
+    const int kBlockFrames = 4096;
+    std::vector<float> block(kBlockFrames * 2);
+    int64_t skip = std::max<int64_t>(0, std::llround((length - renderer.lead()) / snapshot.speed));
+    while (skip > 0) {
+        int n = static_cast<int>(std::min<int64_t>(skip, kBlockFrames));
+        renderer.render(block.data(), n);
+        skip -= n;
+        if (stale()) return;
+    }
+
+    std::unique_ptr<LoopCache> cache(new LoopCache());
+    cache->generation = generation;
+    cache->loopStart = loopStart;
+    cache->loopEnd = loopEnd;
+    cache->speed = snapshot.speed;
+    cache->engine = snapshot.engine;
+    cache->frames = frames;
+    cache->data.resize(static_cast<size_t>(frames + splice) * 2);
+    float* data = cache->data.data();
+    for (int64_t done = 0; done < frames + splice;) {
+        int n = static_cast<int>(std::min<int64_t>(frames + splice - done, kBlockFrames));
+        renderer.render(data + done * 2, n);
+        done += n;
+        if (stale()) return;
+    }
+    for (int64_t i = 0; i < splice; i++) {
+        float w = (i + 0.5f) / splice;
+        data[i * 2] = data[(frames + i) * 2] * (1.0f - w) + data[i * 2] * w;
+        data[i * 2 + 1] = data[(frames + i) * 2 + 1] * (1.0f - w) + data[i * 2 + 1] * w;
+    }
+    cache->data.resize(static_cast<size_t>(frames) * 2);
+
+    if (stale()) return;
+    _publishLoopCache(cache.release());
+}
+
+// Same handshake as _publishTrackList(): the audio thread loads _loopCache
+// only with _audioBusy raised.
+void LiveMixer::_publishLoopCache(LoopCache* cache) {
+    LoopCache* prev = _loopCache.exchange(cache, std::memory_order_seq_cst);
+    if (!prev) return;
+    while (_audioBusy.load(std::memory_order_seq_cst)) {
+        std::this_thread::yield();
+    }
+    delete prev;
+}
+
+// Audio thread: the loaded cache still sounds like the live mix would.
+bool LiveMixer::_loopCacheUsable(bool stretching) {
+    const LoopCache* cache = _activeCache;
+    return cache && stretching && _loopEnabled &&
+           cache->generation == _mixGeneration.load(std::memory_order_acquire) &&
+           cache->loopStart == _loopStart && cache->loopEnd == _loopEnd && cache->speed == _speed &&
+           cache->engine == _engine;
+}
+
+// Audio thread: copies from _cacheIndex on, wrapping, and maps the position.
+void LiveMixer::_readLoopCache(float* output, int numFrames) {
+    const LoopCache* cache = _activeCache;
+    int done = 0;
+    while (done < numFrames) {
+        int run = static_cast<int>(std::min<int64_t>(numFrames - done, cache->frames - _cacheIndex));
+        memcpy(output + done * 2, cache->data.data() + _cacheIndex * 2, run * 2 * sizeof(float));
+        done += run;
+        _cacheIndex += run;
+        if (_cacheIndex >= cache->frames) _cacheIndex = 0;
+    }
+    _currentPosition = cache->loopStart + _cacheIndex * (cache->loopEnd - cache->loopStart) / cache->frames;
+}
+
+// --- PRE-STRETCHED STEMS ---
+
+// One stem of a window: a ring of the window's capacity in output frames (at
+// the track's own channel count), filled by its own stretcher.
+struct LiveMixer::PreStretchStem {
+    std::shared_ptr<TrackStorage> storage; // keeps `source` alive
+    const float* source = nullptr;
+    int64_t sourceFrames = 0;
+    int channels = 0;
+    int group = 0;
+    std::unique_ptr<OwnedTrackStorage> ring;
+
+    // Pre-stretch thread
+    std::unique_ptr<TimeStretcher> stretcher;
+    int64_t fed = 0;      // next source frame fed, negative while in the lead-in
+    int64_t skip = 0;     // output frames still to drop before frame 0
+    int64_t produced = 0; // output frames written
+    bool flushed = false;
+
+    // Starts over so that output frame 0 plays source frame `anchor`. The
+    // lead-in is fed first and its output dropped (see TimeStretcher::startLead()).
+    void reset(int64_t anchor, float speed, int64_t leadIn) {
+        stretcher->clear();
+        fed = anchor - leadIn;
+        skip = std::max<int64_t>(0, std::llround((leadIn - stretcher->startLead(speed)) / speed));
+        produced = 0;
+        flushed = false;
+    }
+
+    // Renders up to output frame `target` (silence past the end of the track).
+    void render(int64_t target, int64_t capacity, std::vector<float>& scratch) {
+        const int kChunkFrames = 4096;
+        if (scratch.size() < static_cast<size_t>(kChunkFrames) * channels) {
+            scratch.resize(kChunkFrames * channels);
+        }
+        while (produced < target) {
+            int want = static_cast<int>(std::min<int64_t>(kChunkFrames, skip + target - produced));
+            int got = stretcher->receiveSamples(scratch.data(), want);
+            if (got > 0) {
+                int dropped = static_cast<int>(std::min<int64_t>(got, skip));
+                skip -= dropped;
+                _write(scratch.data() + dropped * channels, got - dropped, capacity);
+                continue;
+            }
+            if (flushed) {
+                _write(nullptr, target - produced, capacity);
+                break;
+            }
+            if (fed >= sourceFrames) {
+                stretcher->flush();
+                flushed = true;
+                continue;
+            }
+            int n = static_cast<int>(std::min<int64_t>(kChunkFrames, sourceFrames - fed));
+            if (fed < 0) {
+                n = static_cast<int>(std::min<int64_t>(n, -fed));
+                memset(scratch.data(), 0, n * channels * sizeof(float));
+                stretcher->putSamples(scratch.data(), n);
+            } else {
+                stretcher->putSamples(source + fed * channels, n);
+            }
+            fed += n;
+        }
+    }
 
-    if (ma_device_init(NULL, &config, &_device) != MA_SUCCESS) {
-        std::cerr << "Failed to initialize playback device." << std::endl;
-        _deviceInit = false;
-    } else {
-        _deviceInit = true;
+private:
+    // Appends `frames` output frames (silence for nullptr) at ring slot produced % capacity.
+    void _write(const float* in, int64_t frames, int64_t capacity) {
+        float* data = ring->writableData();
+        while (frames > 0) {
+            int64_t slot = produced % capacity;
+            int64_t run = std::min(frames, capacity - slot);
+            if (in) {
+                memcpy(data + slot * channels, in, run * channels * sizeof(float));
+                in += run * channels;
+            } else {
+                memset(data + slot * channels, 0, run * channels * sizeof(float));
+            }
+            produced += run;
+            frames -= run;
+        }
     }
-}
+};
 
-LiveMixer::~LiveMixer() {
-    if (_deviceInit) {
-        ma_device_uninit(&_device);
+// Every stem stretched at one tempo from `anchor` on: output frame i plays
+// source frame anchor + i * speed and sits in ring slot i % capacity. Holds
+// the whole song when the budget allows, otherwise a window that is
+// re-anchored when the playhead leaves it.
+struct LiveMixer::PreStretch {
+    uint64_t generation = 0;
+    uint64_t serial = 0;     // new for every anchor
+    float speed = 1.0f;
+    int engine = kStretchEngineSoundTouch;
+    int64_t sourceFrames = 0; // longest stem
+    bool wholeSong = false;
+    int64_t anchor = 0;
+    int64_t capacity = 0;    // ring length in output frames
+    int64_t frames = 0;      // output frames rendered from the anchor on
+    std::vector<std::unique_ptr<PreStretchStem>> stems;
+    std::atomic<int64_t> written{0};   // output frames rendered for every stem
+    std::atomic<int64_t> readIndex{0}; // oldest frame the audio thread may still read
+
+    int64_t indexOf(int64_t position) const {
+        return std::llround((position - anchor) / static_cast<double>(speed));
     }
-    
-    if (_soundTouch) {
-        soundtouch_destroy(_soundTouch);
-        _soundTouch = nullptr;
+
+    int64_t positionOf(int64_t index) const {
+        return anchor + std::llround(index * static_cast<double>(speed));
     }
 
-    // Cleanup tracks
-    for (auto const& [key, val] : _tracks) {
-        delete val;
+    // Oldest frame the block being rendered after `written` can't overwrite.
+    int64_t oldest(int64_t written) const {
+        return std::max<int64_t>(0, std::min<int64_t>(written + kPreStretchBlockFrames, frames) - capacity);
     }
-    _tracks.clear();
-}
+};
 
+static std::atomic<uint64_t> preStretchSerial{0};
 
-void LiveMixer::startPlayback() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _masterEnvelope = 0.0f;
-    _targetEnvelope = 1.0f;
-    _isPlaying = true;
-    
-    if (_deviceInit) {
-        if (ma_device_start(&_device) != MA_SUCCESS) {
-            std::cerr << "Failed to start playback device." << std::endl;
-        }
-    }
+void LiveMixer::setPreStretchBudget(int64_t bytes) {
+    _preStretchBudget.store(std::max<int64_t>(0, bytes), std::memory_order_release);
+    _stretchChanged();
 }
 
-void LiveMixer::stopPlayback() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _isPlaying = false;
-    
-    if (_deviceInit) {
-        ma_device_stop(&_device);
-    }
+bool LiveMixer::isPlayingPreStretched() {
+    return _preStretchPlaying.load(std::memory_order_acquire);
 }
 
-int64_t LiveMixer::getAtomicPosition() {
-    return _atomicFramesWritten.load(std::memory_order_acquire);
+// Any thread: what the stems sound like once stretched has changed.
+void LiveMixer::_stretchChanged() {
+    _stretchGeneration.fetch_add(1, std::memory_order_acq_rel);
+    { std::lock_guard<std::mutex> lock(_preStretchMutex); }
+    _preStretchWake.notify_one();
+    _mixChanged();
 }
 
-void LiveMixer::addTrack(const char* id, const float* data, int numSamples, int channels) {
-    if (!id || !data || numSamples <= 0) return;
+void LiveMixer::_preStretchLoop() {
+    const auto settle = std::chrono::milliseconds(kPreStretchSettleMs);
+    const auto poll = std::chrono::milliseconds(kPreStretchPollMs);
+    uint64_t settled = 0;
+    bool polling = false; // a window is being filled: keep an eye on the playhead
+    std::unique_lock<std::mutex> lock(_preStretchMutex);
+    while (!_preStretchStopping) {
+        uint64_t generation = _stretchGeneration.load(std::memory_order_acquire);
+        auto moved = [&] {
+            return _preStretchStopping || _stretchGeneration.load(std::memory_order_acquire) != generation;
+        };
+        if (generation != settled) {
+            // A tempo drag changes it every few ms; wait until it stays put
+            if (_preStretchWake.wait_for(lock, settle, moved)) continue;
+            settled = generation;
+        } else if (polling) {
+            if (_preStretchWake.wait_for(lock, poll, moved)) continue;
+        } else {
+            _preStretchWake.wait(lock, moved);
+            continue;
+        }
 
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    // Check if exists
-    if (_tracks.find(id) != _tracks.end()) {
-        delete _tracks[id];
-        _tracks.erase(id);
+        lock.unlock();
+        polling = _updatePreStretch(generation);
+        lock.lock();
     }
-    
-    Track* track = new Track();
-    track->channels = channels;
-    track->data.assign(data, data + numSamples);
-    
-    _tracks[id] = track;
 }
 
-void LiveMixer::removeTrack(const char* id) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_tracks.find(id) != _tracks.end()) {
-        delete _tracks[id];
-        _tracks.erase(id);
-    }
-    _updateAnySolo();
+void LiveMixer::_clearPreStretch() {
+    delete _swapPreStretch(nullptr);
 }
 
-void LiveMixer::setTrackVolume(const char* id, float volume) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_tracks.find(id) != _tracks.end()) {
-        _tracks[id]->volume = volume;
+// Same handshake as _publishTrackList(): returns the previous window once the
+// audio thread can no longer be reading it.
+LiveMixer::PreStretch* LiveMixer::_swapPreStretch(PreStretch* window) {
+    PreStretch* prev = _preStretch.exchange(window, std::memory_order_seq_cst);
+    if (prev) {
+        while (_audioBusy.load(std::memory_order_seq_cst)) {
+            std::this_thread::yield();
+        }
     }
+    return prev;
 }
 
-void LiveMixer::setTrackPan(const char* id, float pan) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_tracks.find(id) != _tracks.end()) {
-        _tracks[id]->pan = pan;
-    }
-}
+// Pre-stretch thread: makes sure there is a window for this generation around
+// the playhead and renders it as far ahead as the audio thread allows. Returns
+// false if there is nothing to do until the stems, tempo or budget change.
+bool LiveMixer::_updatePreStretch(uint64_t generation) {
+    const int64_t leadIn = static_cast<int64_t>(_sampleRate * kPreStretchLeadInSeconds);
+    const int64_t splice = static_cast<int64_t>(_sampleRate * kPreStretchSpliceSeconds);
+    PreStretch* window = _preStretch.load(std::memory_order_acquire);
 
-void LiveMixer::setTrackMute(const char* id, bool muted) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_tracks.find(id) != _tracks.end()) {
-        _tracks[id]->muted = muted;
-    }
-}
+    if (!window || window->generation != generation) {
+        std::unique_ptr<PreStretch> fresh(new PreStretch());
+        int settings[kMaxStretchGroups][kNumSoundTouchSettings];
+        VocoderFrame frames[kMaxStretchGroups];
+        int64_t budget = _preStretchBudget.load(std::memory_order_acquire);
+        bool stretchable = budget > 0;
+        {
+            std::lock_guard<std::mutex> lock(_controlMutex);
+            if (_stretchGeneration.load(std::memory_order_acquire) != generation) return true;
+            fresh->speed = _controls.speed;
+            fresh->engine = _controls.stretchEngine;
+            stretchable = stretchable && fresh->engine != kStretchEngineBypass &&
+                          std::abs(fresh->speed - 1.0f) >= 0.001f;
+            int groups = _numStretchGroups.load(std::memory_order_relaxed);
+            memcpy(settings, _groupSettings, sizeof(_groupSettings));
+            std::copy(_groupFrames, _groupFrames + kMaxStretchGroups, frames);
+            // Muted tracks too: unmuting one must not lose the window. Tracks
+            // still decoding (or compressed ones) keep it off for now.
+            for (Track* track : _trackTable) {
+                if (!stretchable) break;
+                if (!track || !track->committed) continue;
+                TrackLoad* load = track->load.get();
+                if (!track->storage->data() || (load && load->state.load(std::memory_order_acquire) != kTrackLoadReady)) {
+                    stretchable = false;
+                    break;
+                }
+                std::unique_ptr<PreStretchStem> stem(new PreStretchStem());
+                stem->storage = track->storage;
+                stem->source = track->storage->data();
+                stem->sourceFrames = track->storage->frames();
+                stem->channels = track->storage->channels();
+                stem->group = track->stretchGroup.load(std::memory_order_relaxed);
+                if (stem->group >= groups) stem->group = 0;
+                fresh->stems.push_back(std::move(stem));
+            }
+        }
 
-void LiveMixer::setTrackSolo(const char* id, bool solo) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_tracks.find(id) != _tracks.end()) {
-        _tracks[id]->solo = solo;
-        _updateAnySolo();
-    }
-}
+        int64_t channels = 0;
+        for (const auto& stem : fresh->stems) {
+            channels += stem->channels;
+            fresh->sourceFrames = std::max(fresh->sourceFrames, stem->sourceFrames);
+        }
+        int64_t song = static_cast<int64_t>(std::ceil(fresh->sourceFrames / static_cast<double>(fresh->speed))) +
+                       splice + kPreStretchBlockFrames;
+        int64_t affordable = channels > 0 ? budget / (channels * static_cast<int64_t>(sizeof(float))) : 0;
+        fresh->capacity = std::min(song, affordable);
+        fresh->wholeSong = fresh->capacity == song;
+        if (!stretchable || fresh->stems.empty() || fresh->capacity < 4 * kPreStretchBlockFrames) {
+            _clearPreStretch();
+            return false;
+        }
 
-void LiveMixer::_updateAnySolo() {
-    _anySolo = false;
-    for (auto const& [key, track] : _tracks) {
-        if (track->solo) {
-            _anySolo = true;
-            break;
+        fresh->generation = generation;
+        for (auto& stem : fresh->stems) {
+            stem->ring.reset(OwnedTrackStorage::allocate(fresh->capacity * stem->channels, stem->channels));
+            if (!stem->ring) {
+                std::cerr << "LiveMixer: no memory for pre-stretched stems" << std::endl;
+                _clearPreStretch();
+                return false;
+            }
+            stem->stretcher.reset(TimeStretcher::create(fresh->engine, _sampleRate, stem->channels, frames[stem->group]));
+            stem->stretcher->setTempo(fresh->speed);
+            for (int i = 0; i < kNumSoundTouchSettings; i++) {
+                if (settings[stem->group][i] != kNoPendingSetting) {
+                    stem->stretcher->setSetting(i, settings[stem->group][i]);
+                }
+            }
         }
+        fresh->anchor = -1; // anchored (and published) below
+        delete _swapPreStretch(nullptr);
+        window = fresh.release();
     }
-}
 
-void LiveMixer::setLoop(int64_t startSample, int64_t endSample, bool enabled) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _loopStart = startSample;
-    _loopEnd = endSample;
-    _loopEnabled = enabled;
-    
-    // Safety clamp current position if needed? Or let process handle it.
-    if (_loopEnabled && _loopEnd > _loopStart && _currentPosition >= _loopEnd) {
-         _currentPosition = _loopStart;
+    std::vector<float> scratch;
+    for (;;) {
+        if (_stretchGeneration.load(std::memory_order_acquire) != generation) return true;
+
+        Controls controls;
+        {
+            std::lock_guard<std::mutex> lock(_controlMutex);
+            controls = _controls;
+        }
+        int64_t playhead = _atomicFramesWritten.load(std::memory_order_acquire);
+        int64_t written = window->written.load(std::memory_order_acquire);
+        int64_t ahead = static_cast<int64_t>(_sampleRate * kPreStretchMaxBehindSeconds);
+
+        // Re-anchor when the playhead is outside what this window holds or will
+        // soon. A loop that fits is kept whole, anchored at its start.
+        int64_t anchor = window->anchor;
+        bool looping = controls.loopEnabled && controls.loopEnd > controls.loopStart;
+        bool loopFits = looping &&
+            (controls.loopEnd - controls.loopStart) / static_cast<double>(window->speed) + splice + 2 * kPreStretchBlockFrames <=
+            window->capacity;
+        if (window->wholeSong) {
+            anchor = 0;
+        } else if (loopFits && playhead >= controls.loopStart && playhead < controls.loopEnd) {
+            int64_t from = window->indexOf(controls.loopStart);
+            int64_t at = window->indexOf(playhead);
+            if (anchor < 0 || from < window->oldest(written) || at > written + ahead) anchor = controls.loopStart;
+        } else {
+            int64_t at = window->indexOf(playhead);
+            if (anchor < 0 || at < window->oldest(written) || at > written + ahead) {
+                anchor = std::max<int64_t>(0, playhead - leadIn);
+            }
+        }
+        if (anchor != window->anchor) {
+            _swapPreStretch(nullptr); // `window` itself, or nothing before the first anchor
+            window->serial = preStretchSerial.fetch_add(1, std::memory_order_relaxed) + 1;
+            window->anchor = anchor;
+            window->frames = static_cast<int64_t>(std::ceil((window->sourceFrames - anchor) / static_cast<double>(window->speed))) +
+                             splice + kPreStretchBlockFrames;
+            window->written.store(0, std::memory_order_relaxed);
+            window->readIndex.store(0, std::memory_order_relaxed);
+            for (auto& stem : window->stems) {
+                stem->reset(anchor, window->speed, leadIn);
+            }
+            _swapPreStretch(window);
+            written = 0;
+        }
+
+        // Never lap the oldest frame the audio thread may read (with a block to
+        // spare, see PreStretch::oldest()), nor the start of a loop it is going
+        // to wrap back to
+        int64_t limit = std::min(window->frames,
+                                 window->readIndex.load(std::memory_order_seq_cst) + window->capacity - kPreStretchBlockFrames);
+        if (loopFits && window->indexOf(controls.loopStart) >= 0) {
+            limit = std::min(limit, window->indexOf(controls.loopEnd) + splice + kPreStretchBlockFrames);
+        }
+        int64_t next = std::min(written + kPreStretchBlockFrames, limit);
+        if (next <= written) return true;
+
+        for (auto& stem : window->stems) {
+            stem->render(next, window->capacity, scratch);
+        }
+        window->written.store(next, std::memory_order_seq_cst);
     }
 }
 
-void LiveMixer::seek(int64_t positionSample) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _currentPosition = positionSample;
-    
-    if (_soundTouch) {
-        soundtouch_clear(_soundTouch);
+// Audio thread: maps the voices onto the loaded window's stems and checks it
+// can play from output frame `index` on.
+bool LiveMixer::_preStretchUsable(bool stretching, int64_t index, int numFrames, bool entering) {
+    const PreStretch* window = _activeStretch;
+    bool complete = true;
+    for (int v = 0; v < _numVoices; v++) {
+        _voiceStems[v] = nullptr;
+        for (const auto& stem : window->stems) {
+            if (stem->storage.get() == _voices[v].source) {
+                _voiceStems[v] = stem.get();
+                break;
+            }
+        }
+        if (!_voiceStems[v] && (_voices[v].gainL != 0.0f || _voices[v].gainR != 0.0f)) complete = false;
     }
-    
-    // Clear any temporary buffers
-    _mixBuffer.assign(_mixBuffer.size(), 0.0f);
-    
-    // Reset envelope to 0 for a quick 20ms fade-in of the new audio 
-    // to prevent any pops from non-zero crossings
-    _masterEnvelope = 0.0f;
-    
-    // Update UI shadow
-    _atomicFramesWritten.store(_currentPosition, std::memory_order_release);
-}
-int64_t LiveMixer::getPosition() {
-    // This is the old locked getter. 
-    // We should implement new atomic getter.
-    return _atomicFramesWritten.load(std::memory_order_acquire); 
-    // Wait, I reused the variable name from header but confused logic.
-    // Header has `_atomicFramesWritten`. 
-    // Let's use THAT as the "File Position" shadow? No, that's confusing.
-    
-    // I will use `_atomicFramesWritten` to mean "Current File Position Atomic Shadow".
-    // In `process`, I will update it to match `_currentPosition`.
+    if (!stretching || !complete || window->speed != _speed || window->engine != _engine ||
+        window->generation != _stretchGeneration.load(std::memory_order_acquire)) {
+        return false;
+    }
+    // Two blocks, so that there is always one left to fade out of. Entering
+    // also wants a render block in hand, or playback right at the watermark
+    // would drop out again straight away.
+    int frames = numFrames * 2 + (entering ? static_cast<int>(kPreStretchBlockFrames) : 0);
+    return _preStretchReadable(index, frames, true);
 }
 
-void LiveMixer::setSpeed(float speed) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _speed = speed;
-    if (_soundTouch) {
-        soundtouch_setTempo(_soundTouch, speed);
+// Audio thread: whether the frames _readPreStretch() would read from `index`
+// on are rendered and safe from being overwritten. With `publish` the oldest
+// of them becomes the window's readIndex first.
+bool LiveMixer::_preStretchReadable(int64_t index, int numFrames, bool publish) {
+    PreStretch* window = _activeStretch;
+    bool looping = _loopEnabled && _loopEnd > _loopStart;
+    int64_t loopFrom = window->indexOf(_loopStart);
+    int64_t loopTo = window->indexOf(_loopEnd);
+    if (looping && loopTo <= loopFrom) return false;
+    int64_t splice = static_cast<int64_t>(_sampleRate * kPreStretchSpliceSeconds);
+
+    int64_t lowest = index;
+    int64_t highest = index;
+    int64_t at = index;
+    int64_t remaining = numFrames;
+    while (remaining > 0) {
+        if (looping && at >= loopTo) {
+            highest = std::max(highest, at + splice); // faded out after the wrap
+            at = loopFrom;
+            lowest = std::min(lowest, at);
+        }
+        int64_t run = remaining;
+        if (looping) run = std::min(run, loopTo - at);
+        at += run;
+        remaining -= run;
+        highest = std::max(highest, at);
     }
+
+    if (publish) window->readIndex.store(std::max<int64_t>(0, lowest), std::memory_order_seq_cst);
+    int64_t written = window->written.load(std::memory_order_seq_cst);
+    return lowest >= window->oldest(written) && highest <= written;
 }
 
-void LiveMixer::setSoundTouchSetting(int settingId, int value) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_soundTouch) {
-        soundtouch_setSetting(_soundTouch, settingId, value);
+// Audio thread: accumulates output frames [index, index + numFrames) of every
+// voice's stem, with the voice's gains.
+void LiveMixer::_mixPreStretch(float* output, int64_t index, int numFrames) {
+    const PreStretch* window = _activeStretch;
+    int64_t slot = index % window->capacity;
+    int first = static_cast<int>(std::min<int64_t>(numFrames, window->capacity - slot));
+    for (int v = 0; v < _numVoices; v++) {
+        const MixVoice& voice = _voices[v];
+        const PreStretchStem* stem = _voiceStems[v];
+        if (!stem || (voice.gainL == 0.0f && voice.gainR == 0.0f)) continue;
+        const float* data = stem->ring->data();
+        mixRun(output, data + slot * stem->channels, first, stem->channels, voice.gainL, voice.gainR);
+        if (first < numFrames) {
+            mixRun(output + first * 2, data, numFrames - first, stem->channels, voice.gainL, voice.gainR);
+        }
     }
 }
 
-// Internal mixing logic (Raw audio from tracks)
-void LiveMixer::_mixInternal(float* outputBuffer, int numFrames) {
-    // Assumes mutex is ALREADY LOCKED by caller (process)
-    
-    // Clear buffer (silence)
-    memset(outputBuffer, 0, numFrames * 2 * sizeof(float)); // Stereo output
-
-    if (_tracks.empty()) {
-        return; 
-    }
+// Audio thread: mixes the stems from _stretchIndex on and maps the position.
+// At the loop end the stems carry on underneath the loop start for a few ms,
+// fading out, as the live stretcher's overlap would.
+void LiveMixer::_readPreStretch(float* output, int numFrames) {
+    const PreStretch* window = _activeStretch;
+    bool looping = _loopEnabled && _loopEnd > _loopStart;
+    int64_t loopFrom = window->indexOf(_loopStart);
+    int64_t loopTo = window->indexOf(_loopEnd);
+    int splice = static_cast<int>(_sampleRate * kPreStretchSpliceSeconds);
 
-    for (int i = 0; i < numFrames; i++) {
-        // Handle Loop
-        if (_loopEnabled && _loopEnd > _loopStart) {
-             // WRAP CHECK: If we are AT or PAST the end, wrap!
-             if (_currentPosition >= _loopEnd) {
-                 _currentPosition = _loopStart;
-             }
+    memset(output, 0, numFrames * 2 * sizeof(float));
+    int done = 0;
+    while (done < numFrames) {
+        if (looping && _stretchIndex >= loopTo && loopTo > loopFrom) {
+            _wrapTail = _stretchIndex;
+            _wrapFadeLeft = splice;
+            _stretchIndex = loopFrom;
         }
-        
-        float leftSum = 0.0f;
-        float rightSum = 0.0f;
-        
-        // Iterate tracks
-        for (auto const& [key, track] : _tracks) {
-             // Solo-in-place logic: 
-             // If any track is soloed, ONLY soloed tracks play (mute is ignored)
-             if (_anySolo) {
-                 if (!track->solo) continue;
-             } else {
-                 if (track->muted) continue;
-             }
-             
-             int64_t framesAvailable = static_cast<int64_t>(track->data.size()) / track->channels;
-             
-             if (_currentPosition < 0) _currentPosition = 0;
-
-             if (_currentPosition < framesAvailable) {
-                 float lVal = 0.0f;
-                 float rVal = 0.0f;
-                 
-                 size_t sampleIdx = static_cast<size_t>(_currentPosition * track->channels);
-                 
-                 if (sampleIdx < track->data.size() && (sampleIdx + track->channels) <= track->data.size()) {
-                     if (track->channels == 1) {
-                         lVal = track->data[sampleIdx];
-                         rVal = lVal;
-                     } else {
-                         lVal = track->data[sampleIdx];
-                         rVal = track->data[sampleIdx + 1];
-                     }
-                  }
-                 
-                 float lGain = 1.0f;
-                 float rGain = 1.0f;
-                 if (track->pan > 0) lGain = 1.0f - track->pan;
-                 else if (track->pan < 0) rGain = 1.0f + track->pan;
-                 
-                 lVal *= track->volume * lGain;
-                 rVal *= track->volume * rGain;
-                 
-                 leftSum += lVal;
-                 rightSum += rVal;
-             }
+        int run = numFrames - done;
+        if (looping && _stretchIndex < loopTo) run = static_cast<int>(std::min<int64_t>(run, loopTo - _stretchIndex));
+        float* out = output + done * 2;
+        _mixPreStretch(out, _stretchIndex, run);
+
+        if (_wrapFadeLeft > 0) {
+            int fade = std::min(run, _wrapFadeLeft);
+            float* tail = _wrapBlock.data();
+            memset(tail, 0, fade * 2 * sizeof(float));
+            _mixPreStretch(tail, _wrapTail, fade);
+            for (int i = 0; i < fade; i++) {
+                float w = (splice - _wrapFadeLeft + i + 0.5f) / splice;
+                out[i * 2] = out[i * 2] * w + tail[i * 2] * (1.0f - w);
+                out[i * 2 + 1] = out[i * 2 + 1] * w + tail[i * 2 + 1] * (1.0f - w);
+            }
+            _wrapTail += fade;
+            _wrapFadeLeft -= fade;
         }
-        
-        outputBuffer[i*2] = leftSum;
-        outputBuffer[i*2+1] = rightSum;
-        
-        _currentPosition++;
+        _stretchIndex += run;
+        done += run;
     }
+    _currentPosition = window->positionOf(_stretchIndex);
 }
 
-int LiveMixer::process(float* outputBuffer, int numFrames) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    if (!_isPlaying) {
-        memset(outputBuffer, 0, numFrames * 2 * sizeof(float));
-        // Reset envelope so it fades in again when starting
-        _masterEnvelope = 0.0f;
-        return numFrames;
-    }
-    
-    // --- 1.0x SOUNDTOUCH BYPASS OVERRIDE ---
-    // If speed is practically 1.0, bypass SoundTouch and its WSOLA artifacts entirely.
-    bool bypassSoundTouch = std::abs(_speed - 1.0f) < 0.001f;
-    
-    if (bypassSoundTouch) {
+// Live path: mixes the timeline and stretches it (or not, at 1x) into `output`.
+bool LiveMixer::_renderLive(float* output, int numFrames, bool bypassStretch) {
+    bool stalled = false;
+    if (bypassStretch) {
+        _clearStretchers();
+
         // Direct Mixing to Output Buffer
-        _mixInternal(outputBuffer, numFrames);
-        
-        if (_soundTouch) {
-            soundtouch_clear(_soundTouch);
-        }
+        stalled = _mixInternal(output, numFrames) < numFrames;
     } else {
-        if (!_soundTouch) return 0;
-        
-        int samplesReceived = 0;
         int maxIt = 100; // Safety break
         
         // Option 4 Micro-Processing chunk logic applies perfectly to Vocoder as well
-        const int MAX_CHUNK_FRAMES = 512; 
+        const int MAX_CHUNK_FRAMES = 512; // up to kMaxChunkFrames when speeding up
+
+        // Group 0 stretches straight into the output, the others into their own
+        // block, summed below.
+        for (int g = 0; g < _activeGroups; g++) {
+            _groups[g].received = 0;
+        }
         
-        while (samplesReceived < numFrames && maxIt-- > 0) {
-            int neededFrames = numFrames - samplesReceived;
-            
-            // Try receive what's available from SoundTouch
-            int got = soundtouch_receiveSamples(_soundTouch, outputBuffer + (samplesReceived * 2), neededFrames);
-            samplesReceived += got;
-            
-            if (samplesReceived >= numFrames) break;
+        int primeChunks = 0;
+        while (maxIt-- > 0) {
+            // Try receive what's available from every group
+            bool filled = true;
+            bool started = false;
+            for (int g = 0; g < _activeGroups; g++) {
+                StretchGroup& group = _groups[g];
+                _drainStretchGroup(group, g == 0 ? output : group.output.data(), numFrames);
+                if (group.received < numFrames) filled = false;
+                if (group.received > 0) started = true;
+            }
+            if (filled) break;
+
+            // Seek pre-roll: a bounded share per block, which stays silent
+            // (like a stall) until the target comes out at its start
+            if (_seekTarget >= 0 && !started && !_primeInFull && primeChunks++ >= kSeekPrimeChunks) {
+                stalled = true;
+                break;
+            }
             
-            // Ingest more data
+            // Ingest more data: the same chunk of the timeline for all groups,
+            // so they stay in step whatever each one buffers
             int chunkFrames = MAX_CHUNK_FRAMES; 
             if (_speed > 1.0f) {
                 chunkFrames = (int)(MAX_CHUNK_FRAMES * _speed);
-                if (chunkFrames > 1024) chunkFrames = 1024;
-            }
-            
-            if (_mixBuffer.size() < chunkFrames * 2) {
-                _mixBuffer.resize(chunkFrames * 2);
+                if (chunkFrames > kMaxChunkFrames) chunkFrames = kMaxChunkFrames;
             }
             
-            _mixInternal(_mixBuffer.data(), chunkFrames);
+            _chunkStride = _activeGroups > 1 ? chunkFrames * 2 : 0;
             
-            // Feed to SoundTouch
-            soundtouch_putSamples(_soundTouch, _mixBuffer.data(), chunkFrames);
+            _chunkMixed = _mixInternal(_mixBuffer.data(), chunkFrames, _chunkStride);
+            if (_activeGroups > 1) {
+                _stretchWorkers->run(_activeGroups, feedStretchGroupJob, this);
+            } else {
+                _feedStretchGroup(0);
+            }
+            if (_chunkMixed < chunkFrames) {
+                // Decoder hasn't caught up; output what we have and wait
+                stalled = true;
+                break;
+            }
         }
         
-        // Fill remaining with silence if we somehow failed to generate enough (e.g. max iterations reached)
-        if (samplesReceived < numFrames) {
-             memset(outputBuffer + (samplesReceived * 2), 0, (numFrames - samplesReceived) * 2 * sizeof(float));
+        // Fill remaining with silence if we somehow failed to generate enough
+        // (e.g. max iterations reached), then mix the groups after stretching
+        for (int g = 0; g < _activeGroups; g++) {
+            StretchGroup& group = _groups[g];
+            float* out = g == 0 ? output : group.output.data();
+            if (group.received < numFrames) {
+                memset(out + group.received * 2, 0, (numFrames - group.received) * 2 * sizeof(float));
+            }
+            if (g > 0) {
+                mix_stereo_to_stereo(output, out, numFrames, 1.0f, 1.0f);
+            }
+        }
+
+        bool primed = true;
+        for (int g = 0; g < _activeGroups; g++) {
+            if (_groups[g].discard > 0) primed = false;
+        }
+        if (primed) {
+            _seekTarget = -1;
+            _primeInFull = false;
         }
     }
+
+    return stalled;
+}
+
+bool LiveMixer::_renderSource(int source, float* output, int numFrames, bool bypassStretch) {
+    switch (source) {
+        case kOutputLoopCache:
+            _readLoopCache(output, numFrames);
+            return false;
+        case kOutputPreStretch:
+            _readPreStretch(output, numFrames);
+            return false;
+        default:
+            return _renderLive(output, numFrames, bypassStretch);
+    }
+}
+
+int LiveMixer::process(float* outputBuffer, int numFrames) {
+    int done = 0;
+    while (done < numFrames) {
+        int frames = std::min(numFrames - done, _blockFrames);
+        _processBlock(outputBuffer + done * 2, frames);
+        done += frames;
+    }
+    return std::max(0, numFrames);
+}
+
+int LiveMixer::_processBlock(float* outputBuffer, int numFrames) {
+    // Lock-free: pin the current track list for the duration of this block.
+    // See _publishTrackList() for the reclamation side of this handshake.
+    _audioBusy.store(true, std::memory_order_seq_cst);
+    _activeTracks = _trackList.load(std::memory_order_seq_cst);
+    _activeCache = _loopCache.load(std::memory_order_seq_cst);
+    _activeStretch = _preStretch.load(std::memory_order_seq_cst);
+
+    _drainControls();
+
+    // --- STRETCH ENGINE ---
+    // Switched here rather than in _drainControls(): the old engine's last
+    // block is faded out against the new one's first (below)
+    bool playing = _isPlaying.load(std::memory_order_acquire);
+    bool engineFade = (_requestedEngine != _engine || _vocoderPending) && _switchEngine(numFrames, playing);
     
-    // --- APPLY ENVELOPE ---
-    // Smooth 20ms fade based on 44100hz
-    float envelopeStep = 1.0f / (44100.0f * 0.02f); 
+    if (!playing) {
+        memset(outputBuffer, 0, numFrames * 2 * sizeof(float));
+        // Reset envelope so it fades in again when starting
+        _masterEnvelope = 0.0f;
+        _atomicFramesWritten.store(_seekTarget >= 0 ? _seekTarget : _currentPosition, std::memory_order_release);
+        _publishClock(numFrames, false);
+        _audioBusy.store(false, std::memory_order_release);
+        return numFrames;
+    }
     
-    for (int i = 0; i < numFrames; i++) {
-        if (_masterEnvelope < _targetEnvelope) {
-            _masterEnvelope += envelopeStep;
-            if (_masterEnvelope > _targetEnvelope) _masterEnvelope = _targetEnvelope;
-        } else if (_masterEnvelope > _targetEnvelope) {
-            _masterEnvelope -= envelopeStep;
-            if (_masterEnvelope < _targetEnvelope) _masterEnvelope = _targetEnvelope;
+    // --- 1.0x STRETCH BYPASS OVERRIDE ---
+    // If speed is practically 1.0 (or kStretchEngineBypass plays at 1.0),
+    // bypass the stretcher and its artifacts entirely.
+    bool bypassStretch = std::abs(_rate - 1.0f) < 0.001f;
+
+    // --- OUTPUT SOURCE ---
+    // The rendered loop if it still holds, else the pre-stretched stems, else
+    // live stretching. Entering a cached source starts at the frame matching
+    // what live stretching is about to play.
+    int previous = _outputSource;
+    int64_t length = _loopEnd - _loopStart;
+    int64_t heard = _seekTarget >= 0 ? _seekTarget : _currentPosition - static_cast<int64_t>(_stretchBacklog());
+    if (_loopEnabled && length > 0 && heard < _loopStart && _currentPosition >= _loopStart) heard += length;
+
+    int source = kOutputLive;
+    if (_loopCacheUsable(!bypassStretch)) {
+        if (previous == kOutputLoopCache) {
+            source = kOutputLoopCache;
+        } else if (heard >= _loopStart && heard < _loopEnd) {
+            _cacheIndex = (heard - _loopStart) * _activeCache->frames / length;
+            source = kOutputLoopCache;
         }
-        
-        outputBuffer[i*2] *= _masterEnvelope;
-        outputBuffer[i*2 + 1] *= _masterEnvelope;
+    }
+    if (_activeStretch) {
+        // Evaluated even when not chosen: it reports how far back we may read
+        bool resume = previous == kOutputPreStretch && _stretchSerial == _activeStretch->serial;
+        int64_t index = resume ? _stretchIndex : _activeStretch->indexOf(heard);
+        if (_preStretchUsable(!bypassStretch, index, numFrames, !resume) && source == kOutputLive) {
+            if (!resume) {
+                _stretchSerial = _activeStretch->serial;
+                _stretchIndex = index;
+                _wrapFadeLeft = 0;
+            }
+            source = kOutputPreStretch;
+        }
+    }
+
+    // The previous source can only be faded out if it is still there to read
+    bool switching = source != previous;
+    bool continuable = previous == kOutputLive ||
+                       (previous == kOutputLoopCache && _activeCache) ||
+                       (previous == kOutputPreStretch && _activeStretch && _stretchSerial == _activeStretch->serial &&
+                        _preStretchReadable(_stretchIndex, numFrames, false));
+    if (switching && source == kOutputLive) {
+        // Back to live stretching from where the cached source got to
+        _clearStretchers();
+    } else if (source != kOutputLive) {
+        _seekTarget = -1; // a cached source plays the target itself
+    }
+
+    int64_t startPosition = _currentPosition;
+    bool stalled = _renderSource(source, outputBuffer, numFrames, bypassStretch);
+
+    // Switching sources: crossfade over the block from the previous one
+    if (switching && continuable && !stalled) {
+        int64_t position = _currentPosition;
+        _currentPosition = startPosition;
+        _renderSource(previous, _switchBlock.data(), numFrames, bypassStretch);
+        _currentPosition = position;
+        for (int i = 0; i < numFrames; i++) {
+            float w = (i + 0.5f) / numFrames;
+            outputBuffer[i * 2] = outputBuffer[i * 2] * w + _switchBlock[i * 2] * (1.0f - w);
+            outputBuffer[i * 2 + 1] = outputBuffer[i * 2 + 1] * w + _switchBlock[i * 2 + 1] * (1.0f - w);
+        }
+    } else if (switching && !continuable) {
+        _masterEnvelope = 0.0f;
+    } else if (engineFade && !stalled) {
+        // Engine switch: from the old engine's continuation, rendered before
+        // the switch. The two engines don't line up in phase, so the fade
+        // keeps the power rather than the amplitude.
+        for (int i = 0; i < numFrames; i++) {
+            float angle = 1.5707963f * (i + 0.5f) / numFrames;
+            float in = std::sin(angle);
+            float out = std::cos(angle);
+            outputBuffer[i * 2] = outputBuffer[i * 2] * in + _switchBlock[i * 2] * out;
+            outputBuffer[i * 2 + 1] = outputBuffer[i * 2 + 1] * in + _switchBlock[i * 2 + 1] * out;
+        }
+    }
+    _outputSource = source;
+    _cachePlaying.store(source == kOutputLoopCache, std::memory_order_relaxed);
+    _preStretchPlaying.store(source == kOutputPreStretch, std::memory_order_relaxed);
+    
+    // --- APPLY ENVELOPE ---
+    // Smooth 20ms fade at the device rate
+    float envelopeStep = 1.0f / (_sampleRate * 0.02f); 
+    _masterEnvelope = mix_apply_envelope(outputBuffer, numFrames, _masterEnvelope, _targetEnvelope, envelopeStep);
+    if (stalled) {
+        // Fade back in once the decoder catches up instead of clicking
+        _masterEnvelope = 0.0f;
     }
     
     // Update Atomic Shadow for UI
-    _atomicFramesWritten.store(_currentPosition, std::memory_order_release);
+    _atomicFramesWritten.store(_seekTarget >= 0 ? _seekTarget : _currentPosition, std::memory_order_release);
+    _publishClock(numFrames, true);
     
+    _audioBusy.store(false, std::memory_order_release);
     return numFrames;
 }
 
+bool LiveMixer::canPull() {
+    if (!_renderRunning.load(std::memory_order_acquire) && !(_deviceInit && ma_device_is_started(&_device))) {
+        return true;
+    }
+    if (!_pullRefused.exchange(true, std::memory_order_relaxed)) {
+        std::cerr << "LiveMixer: process() pulled while the device renders, returning no frames." << std::endl;
+    }
+    return false;
+}
+
+int LiveMixer::processInt16(int16_t* outputBuffer, int numFrames, bool dither) {
+    if (numFrames <= 0) return 0;
+    size_t samples = static_cast<size_t>(numFrames) * 2;
+    if (_pcmBuffer.size() < samples) _pcmBuffer.resize(samples);
+    int filled = process(_pcmBuffer.data(), numFrames);
+    mix_float_to_int16(outputBuffer, _pcmBuffer.data(), filled * 2, dither ? &_dither : nullptr);
+    return filled;
+}
+
 extern "C" {
     // C Binding Wrappers
     
     EXPORT void* live_mixer_create() {
         return new LiveMixer();
     }
+
+    EXPORT void* live_mixer_create_with_profile(const DeviceProfile* profile) {
+        return profile ? new LiveMixer(*profile) : new LiveMixer();
+    }
+
+    EXPORT bool live_mixer_set_device_profile(void* mixer, const DeviceProfile* profile) {
+        return profile && static_cast<LiveMixer*>(mixer)->setDeviceProfile(*profile);
+    }
+
+    EXPORT bool live_mixer_get_device_info(void* mixer, DeviceInfo* info) {
+        return static_cast<LiveMixer*>(mixer)->getDeviceInfo(info);
+    }
+
+    EXPORT void live_mixer_set_render_ahead(void* mixer, int frames) {
+        static_cast<LiveMixer*>(mixer)->setRenderAhead(frames);
+    }
     
     EXPORT void live_mixer_destroy(void* mixer) {
         if (mixer) delete static_cast<LiveMixer*>(mixer);
     }
     
-    EXPORT void live_mixer_add_track(void* mixer, const char* id, const float* data, int numSamples, int channels) {
-        static_cast<LiveMixer*>(mixer)->addTrack(id, data, numSamples, channels);
+    EXPORT int live_mixer_add_track(void* mixer, const char* id, const float* data, int numSamples, int channels) {
+        return static_cast<LiveMixer*>(mixer)->addTrack(id, data, numSamples, channels);
+    }
+
+    EXPORT int live_mixer_add_track_at_rate(void* mixer, const char* id, const float* data, int numSamples, int channels, int sampleRate) {
+        return static_cast<LiveMixer*>(mixer)->addTrack(id, data, numSamples, channels, sampleRate);
+    }
+
+    EXPORT int live_mixer_get_sample_rate(void* mixer) {
+        return static_cast<LiveMixer*>(mixer)->getSampleRate();
+    }
+
+    // --- ZERO-COPY REGISTRATION ---
+    EXPORT int live_mixer_create_track(void* mixer, const char* id, int64_t numSamples, int channels) {
+        return static_cast<LiveMixer*>(mixer)->createTrack(id, numSamples, channels);
+    }
+
+    EXPORT float* live_mixer_get_track_buffer(void* mixer, int handle) {
+        return static_cast<LiveMixer*>(mixer)->getTrackBuffer(handle);
+    }
+
+    EXPORT bool live_mixer_commit_track(void* mixer, int handle) {
+        return static_cast<LiveMixer*>(mixer)->commitTrack(handle);
+    }
+
+    EXPORT int live_mixer_adopt_track(void* mixer, const char* id, float* data, int64_t numSamples, int channels, TrackReleaseFn release, void* context) {
+        return static_cast<LiveMixer*>(mixer)->adoptTrack(id, data, numSamples, channels, release, context);
+    }
+
+    EXPORT int live_mixer_map_track_file(void* mixer, const char* id, const char* path, int channels) {
+        return static_cast<LiveMixer*>(mixer)->mapTrackFile(id, path, channels);
+    }
+
+    EXPORT int live_mixer_add_compressed_track(void* mixer, const char* id, const float* data, int64_t numSamples, int channels, int codec, int sampleRate) {
+        return static_cast<LiveMixer*>(mixer)->addCompressedTrack(id, data, numSamples, channels, codec, sampleRate);
+    }
+
+    // --- NATIVE FILE LOADING ---
+    EXPORT int live_mixer_add_track_from_file(void* mixer, const char* id, const char* path, TrackLoadProgressFn progress, void* context) {
+        return static_cast<LiveMixer*>(mixer)->addTrackFromFile(id, path, progress, context);
+    }
+
+    EXPORT int live_mixer_add_track_from_memory(void* mixer, const char* id, const void* data, int64_t size,
+                                                TrackReleaseFn release, void* releaseContext,
+                                                TrackLoadProgressFn progress, void* context) {
+        if (size <= 0) return LiveMixer::kInvalidHandle;
+        return static_cast<LiveMixer*>(mixer)->addTrackFromMemory(id, data, static_cast<size_t>(size), release, releaseContext, progress, context);
+    }
+
+    EXPORT int live_mixer_get_track_load_state(void* mixer, int handle, int64_t* decodedFrames, int64_t* totalFrames) {
+        return static_cast<LiveMixer*>(mixer)->getTrackLoadState(handle, decodedFrames, totalFrames);
+    }
+
+    EXPORT bool live_mixer_get_track_info(void* mixer, int handle, int64_t* frames, int* channels) {
+        return static_cast<LiveMixer*>(mixer)->getTrackInfo(handle, frames, channels);
+    }
+
+    EXPORT int live_mixer_get_track_peaks(void* mixer, int handle, int channel, float* out, int points) {
+        return static_cast<LiveMixer*>(mixer)->getTrackPeaks(handle, channel, out, points);
+    }
+
+    EXPORT int live_mixer_get_track_handle(void* mixer, const char* id) {
+        return static_cast<LiveMixer*>(mixer)->getTrackHandle(id);
     }
     
+    // --- STRING-ID EXPORTS (legacy, resolve the handle on every call) ---
     EXPORT void live_mixer_remove_track(void* mixer, const char* id) {
-        static_cast<LiveMixer*>(mixer)->removeTrack(id);
+        auto m = static_cast<LiveMixer*>(mixer);
+        m->removeTrack(m->getTrackHandle(id));
     }
     
     EXPORT void live_mixer_set_volume(void* mixer, const char* id, float volume) {
-        static_cast<LiveMixer*>(mixer)->setTrackVolume(id, volume);
+        auto m = static_cast<LiveMixer*>(mixer);
+        m->setTrackVolume(m->getTrackHandle(id), volume);
     }
 
     EXPORT void live_mixer_set_pan(void* mixer, const char* id, float pan) {
-        static_cast<LiveMixer*>(mixer)->setTrackPan(id, pan);
+        auto m = static_cast<LiveMixer*>(mixer);
+        m->setTrackPan(m->getTrackHandle(id), pan);
     }
     
     EXPORT void live_mixer_set_mute(void* mixer, const char* id, bool muted) {
-        static_cast<LiveMixer*>(mixer)->setTrackMute(id, muted);
+        auto m = static_cast<LiveMixer*>(mixer);
+        m->setTrackMute(m->getTrackHandle(id), muted);
     }
 
     EXPORT void live_mixer_set_solo(void* mixer, const char* id, bool solo) {
-        static_cast<LiveMixer*>(mixer)->setTrackSolo(id, solo);
+        auto m = static_cast<LiveMixer*>(mixer);
+        m->setTrackSolo(m->getTrackHandle(id), solo);
+    }
+
+    // --- HANDLE EXPORTS ---
+    EXPORT void live_mixer_remove_track_handle(void* mixer, int handle) {
+        static_cast<LiveMixer*>(mixer)->removeTrack(handle);
+    }
+
+    EXPORT void live_mixer_set_track_volume(void* mixer, int handle, float volume) {
+        static_cast<LiveMixer*>(mixer)->setTrackVolume(handle, volume);
+    }
+
+    EXPORT void live_mixer_set_track_pan(void* mixer, int handle, float pan) {
+        static_cast<LiveMixer*>(mixer)->setTrackPan(handle, pan);
+    }
+
+    EXPORT void live_mixer_set_track_mute(void* mixer, int handle, bool muted) {
+        static_cast<LiveMixer*>(mixer)->setTrackMute(handle, muted);
+    }
+
+    EXPORT void live_mixer_set_track_solo(void* mixer, int handle, bool solo) {
+        static_cast<LiveMixer*>(mixer)->setTrackSolo(handle, solo);
     }
 
     EXPORT void live_mixer_set_loop(void* mixer, int64_t start, int64_t end, bool enabled) {
@@ -418,7 +3075,15 @@ extern "C" {
     }
     
     EXPORT int live_mixer_process(void* mixer, float* output, int frames) {
-        return static_cast<LiveMixer*>(mixer)->process(output, frames);
+        LiveMixer* m = static_cast<LiveMixer*>(mixer);
+        if (!m->canPull()) return 0;
+        return m->process(output, frames);
+    }
+
+    EXPORT int live_mixer_process_int16(void* mixer, int16_t* output, int frames, bool dither) {
+        LiveMixer* m = static_cast<LiveMixer*>(mixer);
+        if (!m->canPull()) return 0;
+        return m->processInt16(output, frames, dither);
     }
     
     // --- NEW EXPORTS ---
@@ -434,6 +3099,18 @@ extern "C" {
         return static_cast<LiveMixer*>(mixer)->getAtomicPosition();
     }
 
+    EXPORT bool live_mixer_get_playback_clock(void* mixer, PlaybackClock* clock) {
+        return static_cast<LiveMixer*>(mixer)->getPlaybackClock(clock);
+    }
+
+    EXPORT int64_t live_mixer_get_audible_position(void* mixer) {
+        return static_cast<LiveMixer*>(mixer)->getAudiblePosition();
+    }
+
+    EXPORT bool live_mixer_is_stalled(void* mixer) {
+        return static_cast<LiveMixer*>(mixer)->isStalled();
+    }
+
     EXPORT void live_mixer_set_speed(void* mixer, float speed) {
         static_cast<LiveMixer*>(mixer)->setSpeed(speed);
     }
@@ -441,4 +3118,57 @@ extern "C" {
     EXPORT void live_mixer_set_soundtouch_setting(void* mixer, int settingId, int value) {
         static_cast<LiveMixer*>(mixer)->setSoundTouchSetting(settingId, value);
     }
+
+    EXPORT void live_mixer_set_stretch_engine(void* mixer, int engine) {
+        static_cast<LiveMixer*>(mixer)->setStretchEngine(engine);
+    }
+
+    EXPORT int live_mixer_get_stretch_engine(void* mixer) {
+        return static_cast<LiveMixer*>(mixer)->getStretchEngine();
+    }
+
+    EXPORT void live_mixer_set_vocoder_frame(void* mixer, int fftSize, int overlap) {
+        static_cast<LiveMixer*>(mixer)->setVocoderFrame(fftSize, overlap);
+    }
+
+    EXPORT void live_mixer_set_loop_cache_enabled(void* mixer, bool enabled) {
+        static_cast<LiveMixer*>(mixer)->setLoopCacheEnabled(enabled);
+    }
+
+    EXPORT bool live_mixer_is_playing_from_loop_cache(void* mixer) {
+        return static_cast<LiveMixer*>(mixer)->isPlayingFromLoopCache();
+    }
+
+    EXPORT void live_mixer_set_pre_stretch_budget(void* mixer, int64_t bytes) {
+        static_cast<LiveMixer*>(mixer)->setPreStretchBudget(bytes);
+    }
+
+    EXPORT bool live_mixer_is_playing_pre_stretched(void* mixer) {
+        return static_cast<LiveMixer*>(mixer)->isPlayingPreStretched();
+    }
+
+    EXPORT int live_mixer_render_to_file(void* mixer, const char* path, int format, int64_t startFrame, int64_t endFrame,
+                                         RenderProgressFn progress, void* context) {
+        return static_cast<LiveMixer*>(mixer)->renderToFile(path, format, startFrame, endFrame, progress, context);
+    }
+
+    EXPORT int live_mixer_get_render_state(void* mixer, int job, int64_t* framesWritten, int64_t* totalFrames) {
+        return static_cast<LiveMixer*>(mixer)->getRenderState(job, framesWritten, totalFrames);
+    }
+
+    EXPORT void live_mixer_cancel_render(void* mixer, int job) {
+        static_cast<LiveMixer*>(mixer)->cancelRender(job);
+    }
+
+    EXPORT bool live_mixer_set_track_stretch_group(void* mixer, int handle, int group) {
+        return static_cast<LiveMixer*>(mixer)->setTrackStretchGroup(handle, group);
+    }
+
+    EXPORT void live_mixer_set_stretch_group_setting(void* mixer, int group, int settingId, int value) {
+        static_cast<LiveMixer*>(mixer)->setStretchGroupSetting(group, settingId, value);
+    }
+
+    EXPORT void live_mixer_set_stretch_group_vocoder_frame(void* mixer, int group, int fftSize, int overlap) {
+        static_cast<LiveMixer*>(mixer)->setStretchGroupVocoderFrame(group, fftSize, overlap);
+    }
 }
@@ -8,8 +8,18 @@
 #include <cstring>
 #include <cmath>
 #include <atomic>
+#include <string>
+#include <memory>
+#include <thread>
+#include <condition_variable>
 
 #include "miniaudio.h"
+#include "lock_free.h"
+#include "track_storage.h"
+#include "worker_pool.h"
+#include "wav_writer.h"
+#include "mix_kernels.h"
+#include "time_stretcher.h"
 
 #if defined(_WIN32)
 #define EXPORT __declspec(dllexport)
@@ -17,18 +27,154 @@
 #define EXPORT __attribute__((visibility("default"))) __attribute__((used))
 #endif
 
+// Reports decoding progress of a file track from a loader thread.
+// totalFrames is 0 while unknown. The last call has decodedFrames == totalFrames
+// on success, or decodedFrames == -1 on failure.
+typedef void (*TrackLoadProgressFn)(void* context, int handle, int64_t decodedFrames, int64_t totalFrames);
+
+// Reports offline render progress from the render thread. The last call has
+// framesWritten == totalFrames on success, or framesWritten == -1 on failure
+// or cancellation.
+typedef void (*RenderProgressFn)(void* context, int job, int64_t framesWritten, int64_t totalFrames);
+
+enum RenderState {
+    kRenderFailed = -1,
+    kRenderRunning = 0,
+    kRenderDone = 1,
+    kRenderCancelled = 2,
+};
+
+enum TrackLoadState {
+    kTrackLoadFailed = -1,
+    kTrackLoadPending = 0,
+    kTrackLoadReady = 1,
+    kTrackLoadStreaming = 2, // audible up to the decoded watermark, still decoding
+};
+
+enum DeviceBackend {
+    kDeviceBackendAuto = 0, // platform default order
+    kDeviceBackendAAudio = 1,
+    kDeviceBackendOpenSL = 2,
+    kDeviceBackendPulseAudio = 3,
+    kDeviceBackendAlsa = 4,
+    kDeviceBackendWasapi = 5,
+    kDeviceBackendNull = 6, // no output, the callback runs on a timer
+};
+
+// Output device request. Plain C layout (mirrored by a Dart ffi Struct).
+// Zero sizes leave the choice to the backend; an unavailable backend or
+// exclusive mode falls back to the default rather than failing.
+struct DeviceProfile {
+    int32_t periodSizeInFrames = 0;        // takes precedence over milliseconds
+    int32_t periodSizeInMilliseconds = 20;
+    int32_t periods = 3;
+    int32_t lowLatency = 1;                // 0 = ma_performance_profile_conservative
+    int32_t exclusive = 0;                 // 1 = ask for ma_share_mode_exclusive
+    int32_t backend = kDeviceBackendAuto;  // DeviceBackend
+};
+
+// What the device actually negotiated, plus what the callback has observed
+// since the last (re)open. Frames are at LiveMixer::getSampleRate().
+struct DeviceInfo {
+    int32_t backend;             // DeviceBackend in use, kDeviceBackendAuto without a device
+    int32_t sampleRate;
+    int32_t periodSizeInFrames;
+    int32_t periods;
+    int32_t exclusive;
+    int32_t maxCallbackFrames;   // largest block the device pulled, 0 until it has run
+    int32_t outputLatencyFrames; // from process() to the speaker
+    int32_t underruns;           // callbacks that came later than the device buffer lasts
+};
+
+// Audible playback position: the source frame leaving the speaker at
+// timestampNanos (steady clock), after the stretcher and the device buffer.
+// Readers extrapolate with framesPerSecond and wrap at the loop end.
+struct PlaybackClock {
+    int64_t position;
+    int64_t timestampNanos;
+    double framesPerSecond; // source frames per second, 0 while paused or stalled
+    int64_t loopStart;
+    int64_t loopEnd;        // 0 when looping is off
+};
+
 class LiveMixer {
 public:
-    LiveMixer();
+    explicit LiveMixer(const DeviceProfile& profile = DeviceProfile());
     ~LiveMixer();
 
+    static constexpr int kMaxTracks = 128;
+    static constexpr int kInvalidHandle = -1;
+    static constexpr int kDefaultSampleRate = 44100; // if the device can't be opened
+    static constexpr int kMaxStretchGroups = 4;
+    static constexpr int64_t kDefaultPreStretchBudget = 128ll << 20; // bytes
+
+    // The device runs at its native rate; every track buffer, position and loop
+    // point is in frames at this rate.
+    int getSampleRate();
+
+    // Reopens the output with another profile (e.g. stepping down latency until
+    // underruns appear). The sample rate stays what the first open negotiated,
+    // so loaded tracks remain valid. Playback resumes if it was running.
+    bool setDeviceProfile(const DeviceProfile& profile);
+    bool getDeviceInfo(DeviceInfo* info);
+
+    // Render-ahead mode: a high-priority render thread mixes and stretches up
+    // to `frames` ahead into a lock-free ring, and the device callback only
+    // copies from it, so a slow WSOLA iteration no longer overruns a period.
+    // Controls (faders, tempo) take effect that much later; seeks flush the
+    // ring. 0 renders inside the callback (default). Don't call process()
+    // yourself while it is on.
+    void setRenderAhead(int frames);
+
     // Track Management
-    void addTrack(const char* id, const float* data, int numSamples, int channels);
-    void removeTrack(const char* id);
-    void setTrackVolume(const char* id, float volume);
-    void setTrackPan(const char* id, float pan);
-    void setTrackMute(const char* id, bool muted);
-    void setTrackSolo(const char* id, bool solo);
+    // addTrack returns a stable handle (kInvalidHandle on failure). Re-adding an
+    // existing id replaces its audio and keeps the same handle.
+    // `sampleRate` is the rate of `data` (0 = already at getSampleRate());
+    // anything else is resampled once here.
+    int addTrack(const char* id, const float* data, int numSamples, int channels, int sampleRate = 0);
+    int getTrackHandle(const char* id);
+
+    // Zero-copy registration.
+    // createTrack allocates an aligned mixer-owned buffer; fill it through
+    // getTrackBuffer() and call commitTrack() to make it audible.
+    int createTrack(const char* id, int64_t numSamples, int channels);
+    float* getTrackBuffer(int handle);
+    bool commitTrack(int handle);
+    // adoptTrack mixes straight from the caller's buffer and calls
+    // release(context) once the mixer is done with it. On failure (returns
+    // kInvalidHandle) ownership stays with the caller.
+    int adoptTrack(const char* id, float* data, int64_t numSamples, int channels, TrackReleaseFn release, void* context);
+    // mapTrackFile plays a 32-bit float WAV (or raw float file with `channels`)
+    // straight from a read-only memory map, paged in on demand. A WAV at another
+    // rate can't be mapped as is; it is resampled into memory instead.
+    int mapTrackFile(const char* id, const char* path, int channels);
+    // addCompressedTrack keeps the track as int16 or lossless blocks (TrackCodec)
+    // and decodes around the playhead while mixing. kTrackCodecFloat32 behaves
+    // like addTrack.
+    int addCompressedTrack(const char* id, const float* data, int64_t numSamples, int channels, int codec, int sampleRate = 0);
+
+    // Native decoding (WAV / FLAC / MP3 through ma_decoder) on a loader pool, so
+    // all stems of an exercise decode concurrently, straight into the final
+    // track buffer. Both return the handle immediately. Once the length is known
+    // the track turns kTrackLoadStreaming and plays up to the decoded watermark;
+    // playback stalls (silence, position held) if it catches up with it.
+    int addTrackFromFile(const char* id, const char* path, TrackLoadProgressFn progress, void* context);
+    // `data` holds an encoded file; release(releaseContext) runs once the decode is
+    // over (successful or not). If this returns kInvalidHandle the caller keeps `data`.
+    int addTrackFromMemory(const char* id, const void* data, size_t size, TrackReleaseFn release, void* releaseContext,
+                           TrackLoadProgressFn progress, void* context);
+    // Returns a TrackLoadState. Frame counts are optional out-params.
+    int getTrackLoadState(int handle, int64_t* decodedFrames, int64_t* totalFrames);
+    bool getTrackInfo(int handle, int64_t* frames, int* channels);
+    // Waveform overview: `points` peak magnitudes of `channel`. Returns the
+    // number written (0 for tracks without flat PCM, e.g. compressed ones).
+    int getTrackPeaks(int handle, int channel, float* out, int points);
+
+    void removeTrack(int handle);
+    void setTrackVolume(int handle, float volume);
+    void setTrackPan(int handle, float pan);
+    void setTrackMute(int handle, bool muted);
+    void setTrackSolo(int handle, bool solo);
 
     // Global Settings
     void setLoop(int64_t startSample, int64_t endSample, bool enabled);
@@ -38,31 +184,206 @@ public:
     // --- NATIVE OUTPUT CONTROL ---
     void startPlayback();
     void stopPlayback();
-    int64_t getAtomicPosition(); // Returns frames played (hardware compensated)
+    int64_t getAtomicPosition(); // Returns the last source frame mixed (ahead of what is audible)
+    // Latency-compensated position (stretcher + device buffer), extrapolated to
+    // now. Use this for anything drawn against what the user hears.
+    bool getPlaybackClock(PlaybackClock* clock);
+    int64_t getAudiblePosition();
+    bool isStalled(); // waiting for a streaming track to decode further
     
     void setSpeed(float speed);
+    // Applies to every stretch group.
     void setSoundTouchSetting(int settingId, int value);
 
+    // Stretch engine (StretchEngine): SoundTouch WSOLA, the phase Vocoder, or
+    // bypass (plays at 1x whatever the tempo). Switchable while playing: the
+    // new engine's stretchers are warmed up on what is being heard and
+    // crossfaded in over one block. SoundTouch settings only affect SoundTouch.
+    void setStretchEngine(int engine);
+    int getStretchEngine();
+    // Vocoder analysis frame: FFT size and overlap (rounded to powers of two,
+    // see Vocoder), e.g. 1024/4 for rhythmic material, 4096/4 for sustained
+    // piano. 0 keeps the default. Applies to every stretch group; while the
+    // Vocoder is playing, the new frame is crossfaded in like an engine switch.
+    void setVocoderFrame(int fftSize, int overlap);
+
+    // Stretch groups: each group has its own stretchers (and settings,
+    // e.g. a short-sequence profile for drums and bass, a long one for flute and
+    // piano). Groups are stretched in parallel on a few worker threads and mixed
+    // after stretching. Every track starts in group 0; a group comes into
+    // existence the first time a track is assigned to it.
+    bool setTrackStretchGroup(int handle, int group);
+    void setStretchGroupSetting(int group, int settingId, int value);
+    void setStretchGroupVocoderFrame(int group, int fftSize, int overlap);
+
+    // Rendered-loop cache: once a stretched loop has kept the same mix, tempo
+    // and range for a moment, a background thread renders one seamless pass of
+    // it and playback switches to that (crossfaded, position mapped frame by
+    // frame). Any change drops back to live stretching until it is rebuilt.
+    // On by default; only flat PCM tracks (not compressed ones) are cached.
+    void setLoopCacheEnabled(bool enabled);
+    bool isPlayingFromLoopCache();
+
+    // Pre-stretched stems: at a tempo other than 1x a background thread
+    // stretches every stem on its own into a cache of up to `bytes` (the whole
+    // song if it fits, otherwise a window that follows the playhead). Where it
+    // covers the playhead, playback only mixes the stretched stems, so volume,
+    // pan, mute and solo cost no WSOLA and keep it valid; anything not rendered
+    // yet plays through the live stretchers. Tempo, SoundTouch settings and
+    // stretch groups start it over. 0 turns it off.
+    void setPreStretchBudget(int64_t bytes);
+    bool isPlayingPreStretched();
+
+    // Offline export: renders source frames [startFrame, endFrame) of the
+    // current mix (tracks, gains, tempo, stretch groups) through the same
+    // mixing and stretch code as playback to a WAV file (WavSampleFormat) at
+    // the mixer rate, RF64 past 4 GB. endFrame <= 0 means the end of the
+    // longest track. Runs on its own thread as fast as the CPU allows and
+    // needs no device. Returns a job id, or kInvalidHandle if a track is still
+    // decoding or compressed, the range is empty or the file can't be created.
+    int renderToFile(const char* path, int format, int64_t startFrame, int64_t endFrame,
+                     RenderProgressFn progress, void* context);
+    // Returns a RenderState. Frame counts (output frames) are optional out-params.
+    int getRenderState(int job, int64_t* framesWritten, int64_t* totalFrames);
+    // The partial file is deleted.
+    void cancelRender(int job);
+
     // Audio Processing
     // mix into outputBuffer (interleaved stereo)
     // returns number of frames filled (should match numFrames unless EOS and not looping)
     int process(float* outputBuffer, int numFrames);
+    // process() converted to interleaved 16-bit PCM in the caller's buffer
+    // (numFrames * 2 samples): clamped and, with `dither`, TPDF-dithered.
+    // For streaming the mix out through the host instead of the device.
+    int processInt16(int16_t* outputBuffer, int numFrames, bool dither);
+    // process() has a single caller at a time. False (reported once) while
+    // the started device or the render-ahead thread drives it; the pull
+    // exports live_mixer_process / live_mixer_process_int16 then return 0.
+    bool canPull();
 
 private:
+   // --- THREADING MODEL ---
+   // Control calls (Dart thread) never touch audio-thread state directly.
+   // - Per-track parameters are atomics read once per block.
+   // - Global parameters are published as a Controls block through a TripleBuffer.
+   // - Seeks are a single pending atomic (last one wins).
+   // - The track set is an immutable TrackList swapped atomically; the old list is
+   //   reclaimed by the control thread once the audio thread has left process().
+   // process() therefore never takes a lock, and has exactly one caller at a
+   // time: the device callback, the render-ahead thread, or (device stopped)
+   // the host pulling through the process exports.
+   struct TrackLoad {
+       std::atomic<bool> cancelled{false};
+       std::atomic<int> state{kTrackLoadPending};
+       std::atomic<int64_t> decodedFrames{0};
+       std::atomic<int64_t> totalFrames{0};
+   };
+
+   struct TrackLoadSource {
+       std::string path;             // file, or empty for memory
+       const void* data = nullptr;
+       size_t size = 0;
+       TrackReleaseFn release = nullptr;
+       void* releaseContext = nullptr;
+       TrackLoadProgressFn progress = nullptr;
+       void* progressContext = nullptr;
+   };
+
    struct Track {
-       std::vector<float> data;
-       int channels;
-       float volume = 1.0f;
-       float pan = 0.0f;
-       bool muted = false;
-       bool solo = false;
+       ~Track() {
+           if (load) load->cancelled.store(true, std::memory_order_release);
+       }
+
+       std::shared_ptr<TrackStorage> storage; // shared with a loader still decoding into it
+       float* fillBuffer = nullptr; // set until a created track is committed
+       bool committed = true;       // control thread only: part of the published list
+       std::shared_ptr<TrackLoad> load; // set while (or after) decoding on the loader pool
+       bool paged = false;          // storage wants read-ahead hints (see TrackStorage)
+       int64_t prefetchFrom = 0;    // audio thread only: last hinted window
+       int64_t prefetchUntil = 0;
+       std::atomic<float> volume{1.0f};
+       std::atomic<float> pan{0.0f};
+       std::atomic<bool> muted{false};
+       std::atomic<bool> solo{false};
+       std::atomic<int> stretchGroup{0};
+   };
+
+   struct TrackList {
+       std::vector<Track*> tracks;
+   };
+
+   struct Controls {
+       float speed = 1.0f;
+       int stretchEngine = kStretchEngineSoundTouch;
+       bool loopEnabled = false;
+       int64_t loopStart = 0;
+       int64_t loopEnd = 0;
    };
 
-   std::map<std::string, Track*> _tracks;
-   std::mutex _mutex;
+   static constexpr int kNumSoundTouchSettings = 8;
+   static constexpr int kNoPendingSetting = -1;
+   static constexpr int64_t kNoPendingSeek = -1;
+   int _sampleRate = kDefaultSampleRate; // negotiated with the device, fixed after construction
+   int64_t _prefetchFrames = kDefaultSampleRate * 2; // read-ahead window for paged tracks (2 s)
+
+   // Control thread side (guarded by _controlMutex, never locked by process())
+   std::vector<Track*> _trackTable;          // handle -> track, nullptr for free slots
+   std::map<std::string, int> _trackHandles; // string ids -> handle (legacy exports)
+   std::mutex _controlMutex;
+   Controls _controls;
+   int _groupSettings[kMaxStretchGroups][kNumSoundTouchSettings]; // last value per group, kNoPendingSetting if never set
+   VocoderFrame _groupFrames[kMaxStretchGroups];
+   void _publishTrackList(Track* retired);
+   Track* _trackForHandle(int handle);
+   int _insertTrack(const char* id, Track* track);
+
+   // Loader pool (created on first file load)
+   std::unique_ptr<WorkerPool> _loaders;
+   int _beginTrackLoad(const char* id, const TrackLoadSource& source);
+   void _decodeTrack(int handle, std::shared_ptr<TrackLoad> load, const TrackLoadSource& source);
+   bool _publishTrackLoad(int handle, const std::shared_ptr<TrackLoad>& load,
+                          const std::shared_ptr<OwnedTrackStorage>& storage, int state);
+
+   // Shared between threads
+   std::atomic<TrackList*> _trackList{nullptr};
+   std::atomic<bool> _audioBusy{false};
+   TripleBuffer<Controls> _controlsBuffer;
+   std::atomic<int64_t> _pendingSeek{kNoPendingSeek};
+   std::atomic<bool> _isPlaying{false};
+   std::atomic<bool> _pullRefused{false}; // the refused pull has been reported once
+   std::atomic<bool> _fadeInPending{false}; // set by startPlayback(), consumed by _drainControls()
+
+   // Audio thread side
+   TrackList* _activeTracks = nullptr;
+   void _drainControls();
+
+   // Dense per-block view of the audible tracks. Rebuilt once per process() from
+   // the track atomics so the per-frame loop only walks a flat array of PODs.
+   struct MixVoice {
+       const float* data;     // flat PCM, or nullptr to pull through source->decodeAt()
+       TrackStorage* source;
+       int64_t frames;        // readable frames (decode watermark while streaming)
+       bool streaming;        // still decoding: reaching `frames` stalls the mix
+       const float* peaks;    // activity map (TrackStorage::blockPeaks), nullptr if none
+       int channels;
+       int group;             // stretch group
+       float gainL;
+       float gainR;
+   };
+   MixVoice _voices[kMaxTracks];
+   int _numVoices = 0;
+   void _buildVoices();
+   static bool _voiceForTrack(Track* track, bool anySolo, MixVoice& voice);
+   // Mixes the audible blocks of [position, position + frames); true if any.
+   static bool _mixVoice(const MixVoice& voice, float* out, int64_t position, int frames);
+   static void _mixVoiceRun(const MixVoice& voice, float* out, int64_t position, int frames);
+   // Like _mixInternal() for the output of whichever source is playing
+   // (OutputSource); returns true if it stalled.
+   bool _renderSource(int source, float* output, int numFrames, bool bypassStretch);
+   bool _renderLive(float* output, int numFrames, bool bypassStretch);
+   void _prefetchPagedTracks();
 
    int64_t _currentPosition = 0;
-   bool _isPlaying = false;
    
    // Loop
    bool _loopEnabled = false;
@@ -73,28 +394,217 @@ private:
    float _masterEnvelope = 1.0f;
    float _targetEnvelope = 1.0f;
    
-   // Internal mixing logic (raw, no speed)
-   void _mixInternal(float* outputBuffer, int numFrames);
+   // Internal mixing logic (raw, no speed). Returns the frames produced; fewer
+   // than numFrames means the playhead caught up with a streaming track.
+   // With a groupStride every stretch group gets its own block, at
+   // outputBuffer + group * groupStride; 0 mixes all of them together.
+   int _mixInternal(float* outputBuffer, int numFrames, int groupStride = 0);
+   std::atomic<bool> _stalled{false};
+
+   // Audible position (see getPlaybackClock). The audio thread publishes one
+   // clock per block; the control side keeps the last one it read.
+   TripleBuffer<PlaybackClock> _clockBuffer;
+   PlaybackClock _clock = {};  // control thread, under _controlMutex
+   int64_t _audiblePosition = 0;
+   int64_t _positionFloor = -1; // hold at a seek/start target until its audio reaches the speaker
+   std::atomic<bool> _clockResume{false}; // set by startPlayback(): the device buffer starts over
+   double _stretchBacklog();
+   void _publishClock(int numFrames, bool audible);
 
-   // Solo logic helper
+   // Solo logic helper (recomputed by the audio thread once per block)
    bool _anySolo = false;
    void _updateAnySolo();
    
    // --- MINIAUDIO ---
    ma_device _device;
    bool _deviceInit = false;
+   ma_context _context;       // only for an explicit backend, otherwise miniaudio's default
+   bool _contextInit = false;
    std::atomic<int64_t> _atomicFramesWritten{0};
-   
-   // --- SOUNDTOUCH ---
-   void* _soundTouch = nullptr; // Void* to avoid forcing C++ dependency in header if not needed, but here we can include it.
-   // Actually, since this is a private member of a C++ class not exported in DLL interface directly (only via C wrappers), 
-   // we can use forward declaration or void* to keep compilation cleaner/faster, or just include it.
-   // Wrapper used "soundtouch/include/SoundTouch.h".
-   // Let's use void* and cast in cpp to minimize header mess, or include if we want unique_ptr.
-   // Simpler: void* _soundTouch; 
-   
-   float _speed = 1.0f;
-   std::vector<float> _mixBuffer; // Intermediate buffer for mixing before SoundTouch
+   bool _openDevice(const DeviceProfile& profile, int sampleRate);
+   void _closeDevice();
+
+   // Render-ahead mode (see setRenderAhead). Switched only while the device is stopped.
+   static constexpr int kRenderBlockFrames = 256;
+   std::unique_ptr<SpscRing<float>> _renderRing; // interleaved stereo, nullptr when off
+   int _renderAheadFrames = 0;
+   int _renderAheadRequest = 0; // setRenderAhead() argument, resized for each device
+   std::thread _renderThread;
+   std::atomic<bool> _renderRunning{false};
+   std::atomic<uint64_t> _ringDiscard{0};  // ring position the callback skips to (set on seeks)
+   std::atomic<bool> _outputResume{false}; // callback fades in from the ring after a start
+   bool _ringPrimed = false;               // callback: an empty ring counts as an underrun
+   float _outputEnvelope = 0.0f;           // callback side fade
+   bool _seekApplied = false;              // set by _drainControls() for the render loop
+   void _renderLoop();
+   void _startRenderThread(int frames);
+   void _stopRenderThread();
+   void _playFromRing(float* output, int numFrames);
+
+   // Callback timing, measured on the audio thread
+   double _deviceBufferSeconds = 0.0; // period * periods, fixed while the device runs
+   int _devicePeriodFrames = 0;       // at _sampleRate, 0 without a device (external process() calls)
+   int _devicePeriods = 0;
+   int64_t _lastCallbackNanos = 0;    // 0 = first callback since start
+   std::atomic<bool> _callbackClockReset{true};
+   std::atomic<int> _maxCallbackFrames{0};
+   std::atomic<int> _underruns{0};
+   void _measureCallback(int frameCount);
+
+   // --- STRETCHERS ---
+   // One stretcher per engine per stretch group, so that switching engines
+   // never allocates on the audio thread; only _engine's is fed. Groups
+   // [0, _numStretchGroups) exist; the control thread creates new ones fully
+   // configured before publishing the count, and none is ever removed.
+   struct StretchGroup {
+       std::unique_ptr<TimeStretcher> stretchers[kNumStretchEngines]; // nullptr for kStretchEngineBypass
+       std::atomic<int> pendingSettings[kNumSoundTouchSettings];
+       // New Vocoder frame: the control thread publishes a fresh stretcher,
+       // the audio thread swaps it in and hands the old one back to be freed.
+       std::atomic<TimeStretcher*> pendingVocoder{nullptr};
+       std::atomic<TimeStretcher*> retiredVocoder{nullptr};
+       std::vector<float> output; // stretched block, groups > 0 (group 0 writes the output directly)
+
+       // Audio thread
+       bool audible = false;       // its voices mixed at least one active block this chunk
+       bool hasVoices = false;     // it has audible voices this block
+       int received = 0;           // frames of the current block produced
+       // Silence fast path: once the stretcher has only been fed silence for longer
+       // than it buffers, silent input skips it and becomes output zeros directly.
+       int64_t silentFrames = 0;   // consecutive silent frames fed to the stretcher
+       double idleSilence = 0.0;   // output frames of silence owed to the device
+       int64_t discard = 0;        // seek pre-roll output still to drop
+   };
+   StretchGroup _groups[kMaxStretchGroups];
+   std::atomic<int> _numStretchGroups{1};
+   int _activeGroups = 1;          // audio thread: snapshot for this block
+   std::unique_ptr<BlockWorkers> _stretchWorkers; // created with the second group
+   void _addStretchGroups(int count);
+   void _createStretchers(int group);
+   TimeStretcher* _newStretcher(int engine, int group);
+   void _replaceVocoder(int group);
+
+   // Audio thread
+   float _speed = 1.0f; // Tempo currently applied to the stretchers
+   float _rate = 1.0f;  // source frames per output frame: _speed, or 1 with kStretchEngineBypass
+   int _engine = kStretchEngineSoundTouch;          // whose stretchers are fed
+   int _requestedEngine = kStretchEngineSoundTouch; // from Controls, switched by process()
+   bool _vocoderPending = false; // a new Vocoder frame waits for the next switch
+   bool _switchEngine(int numFrames, bool playing);
+   void _adoptVocoders();
+   static constexpr int kMaxChunkFrames = 1024;    // timeline frames mixed per stretcher feed
+   static constexpr int kDefaultBlockFrames = 1024; // block capacity before (or without) a device
+   std::vector<float> _mixBuffer; // Intermediate buffer for mixing before stretching (one chunk per group)
+   // Scratch blocks of the audio path are sized up front for blocks of up to
+   // _blockFrames (control thread, nothing rendering); process() renders
+   // longer requests in pieces, so the audio thread never allocates.
+   int _blockFrames = 0;
+   void _reserveBlockFrames(int frames);
+   int _processBlock(float* outputBuffer, int numFrames);
+   std::vector<float> _pcmBuffer; // processInt16(): float block before conversion, grows to the largest request
+   MixDither _dither;
+   int _chunkStride = 0;          // floats between group blocks in _mixBuffer
+   int _chunkMixed = 0;           // frames in the current chunk
+   // Seek pre-roll: the stretchers are primed with audio from just before the
+   // target and drop their output up to it, spread over the first blocks.
+   int64_t _seekTarget = -1;      // audio thread: target being primed for, -1 when not
+   bool _primeInFull = false;     // audio thread: prime within one block (engine switch)
+   void _clearStretchers();
+   void _primeStretchers(int64_t target, bool inFull);
+   void _drainStretchGroup(StretchGroup& group, float* output, int numFrames);
+   void _feedStretchGroup(int group);
+   static void feedStretchGroupJob(void* context, int group);
+
+   // --- OFFLINE RENDERING ---
+   // A copy of the mix (voices holding their storage, tempo, group settings)
+   // that can be rendered through fresh stretchers away from the audio thread.
+   struct MixSnapshot;
+   class StretchRenderer;
+   bool _snapshotMix(MixSnapshot& snapshot); // under _controlMutex
+
+   // --- OFFLINE EXPORT ---
+   // Jobs are never removed (ids are indices + 1); a finished job's thread is
+   // joined when the next one starts or with the mixer.
+   struct RenderJob {
+       std::atomic<bool> cancelled{false};
+       std::atomic<int> state{kRenderRunning};
+       std::atomic<int64_t> framesWritten{0};
+       int64_t totalFrames = 0;
+       int sampleRate = 0;
+       std::thread thread;
+   };
+   std::mutex _renderJobsMutex;
+   std::vector<std::unique_ptr<RenderJob>> _renderJobs;
+   class ExportStream;
+   void _renderJob(int job, RenderJob* state, std::shared_ptr<MixSnapshot> snapshot, std::string path,
+                   WavWriter* writer, int64_t startFrame, RenderProgressFn progress, void* context);
+   bool _renderSegments(RenderJob* state, const MixSnapshot& snapshot, WavWriter* file, int64_t startFrame,
+                        const std::function<void(int64_t)>& report);
+
+   // --- RENDERED-LOOP CACHE ---
+   // Every change that affects what the loop sounds like bumps _mixGeneration;
+   // the cache thread renders once it stays put for a moment, and the audio
+   // thread only plays a cache whose generation is still current. Caches are
+   // swapped like the track list (see _publishTrackList).
+   struct LoopCache;
+   std::atomic<uint64_t> _mixGeneration{1};
+   std::atomic<LoopCache*> _loopCache{nullptr};
+   std::atomic<bool> _loopCacheEnabled{true};
+   std::thread _loopCacheThread;           // started with the first loop
+   std::mutex _loopCacheMutex;
+   std::condition_variable _loopCacheWake;
+   bool _loopCacheStopping = false;        // guarded by _loopCacheMutex
+   void _mixChanged();
+   void _loopCacheLoop();
+   void _renderLoopCache(uint64_t generation);
+   void _publishLoopCache(LoopCache* cache);
+   // Audio thread
+   LoopCache* _activeCache = nullptr;      // loaded once per block
+   int64_t _cacheIndex = 0;                // next cache frame
+   std::atomic<bool> _cachePlaying{false}; // for isPlayingFromLoopCache()
+   bool _loopCacheUsable(bool stretching);
+   void _readLoopCache(float* output, int numFrames);
+
+   // --- PRE-STRETCHED STEMS ---
+   // Only tempo, stretch engine, SoundTouch settings, stretch groups and the
+   // track set change what a stem sounds like once stretched; they bump
+   // _stretchGeneration (and the mix). The pre-stretch thread alone publishes
+   // windows. The audio thread reads a window only below its `written`
+   // watermark and reports the oldest frame it may still read, which the
+   // thread never overwrites.
+   struct PreStretchStem;
+   struct PreStretch;
+   std::atomic<uint64_t> _stretchGeneration{1};
+   std::atomic<PreStretch*> _preStretch{nullptr};
+   std::atomic<int64_t> _preStretchBudget{kDefaultPreStretchBudget};
+   std::thread _preStretchThread;          // started with the first tempo other than 1x
+   std::mutex _preStretchMutex;
+   std::condition_variable _preStretchWake;
+   bool _preStretchStopping = false;       // guarded by _preStretchMutex
+   void _stretchChanged();
+   void _preStretchLoop();
+   bool _updatePreStretch(uint64_t generation);
+   PreStretch* _swapPreStretch(PreStretch* window);
+   void _clearPreStretch();
+   // Audio thread
+   PreStretch* _activeStretch = nullptr;   // loaded once per block
+   uint64_t _stretchSerial = 0;            // window (and anchor) _stretchIndex belongs to
+   int64_t _stretchIndex = 0;              // next output frame of the window
+   int64_t _wrapTail = 0;                  // loop wrap: frames past the loop end being faded out
+   int _wrapFadeLeft = 0;
+   std::vector<float> _wrapBlock;          // _blockFrames, see _reserveBlockFrames()
+   const PreStretchStem* _voiceStems[kMaxTracks]; // per _voices entry, nullptr if not pre-stretched
+   std::atomic<bool> _preStretchPlaying{false};   // for isPlayingPreStretched()
+   bool _preStretchUsable(bool stretching, int64_t index, int numFrames, bool entering);
+   bool _preStretchReadable(int64_t index, int numFrames, bool publish);
+   void _mixPreStretch(float* output, int64_t index, int numFrames);
+   void _readPreStretch(float* output, int numFrames);
+
+   // Where the output comes from. A change is crossfaded over one block
+   // against the previous source's continuation (in _switchBlock).
+   enum OutputSource { kOutputLive, kOutputLoopCache, kOutputPreStretch };
+   int _outputSource = kOutputLive;
+   std::vector<float> _switchBlock;        // _blockFrames, see _reserveBlockFrames()
 
    static void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
 };
@@ -0,0 +1,127 @@
+#ifndef LOCK_FREE_H
+#define LOCK_FREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// --- LOCK-FREE PRIMITIVES FOR THE AUDIO THREAD ---
+// Everything in here is safe to touch from the miniaudio callback:
+// no locks, no allocation, no syscalls.
+
+// Single-producer / single-consumer "latest value" mailbox.
+// The control thread publishes a whole parameter block with write(); the audio
+// thread picks up the most recent one with read(). Intermediate values may be
+// skipped (a fader drag only needs its last position), so it can never overflow
+// even when nobody is consuming (e.g. device stopped).
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) {
+        _slots[0] = initial;
+        _slots[1] = initial;
+        _slots[2] = initial;
+    }
+
+    // Producer side. Never blocks.
+    void write(const T& value) {
+        _slots[_back] = value;
+        int prev = _middle.exchange(_back | kDirty, std::memory_order_acq_rel);
+        _back = prev & kIndexMask;
+    }
+
+    // Consumer side. Returns false if nothing new was published since the last read.
+    bool read(T& out) {
+        if ((_middle.load(std::memory_order_acquire) & kDirty) == 0) return false;
+        int prev = _middle.exchange(_front, std::memory_order_acq_rel);
+        _front = prev & kIndexMask;
+        out = _slots[_front];
+        return true;
+    }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kDirty = 4;
+
+    T _slots[3];
+    int _back = 0;  // owned by producer
+    int _front = 1; // owned by consumer
+    std::atomic<int> _middle{2};
+};
+
+// Single-producer / single-consumer FIFO (e.g. interleaved frames rendered
+// ahead of the device callback). Capacity is fixed at construction, rounded up
+// to a power of two; after that both ends are wait-free and never allocate.
+// Positions are running 64-bit counts, so they never wrap.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        _buffer.resize(size);
+        _mask = size - 1;
+    }
+
+    size_t capacity() const { return _buffer.size(); }
+
+    // Either side: items currently queued.
+    size_t readable() const {
+        return static_cast<size_t>(_write.load(std::memory_order_acquire) - _read.load(std::memory_order_acquire));
+    }
+
+    // Producer side. Writes as much of `data` as fits; returns the count written.
+    size_t write(const T* data, size_t count) {
+        uint64_t write = _write.load(std::memory_order_relaxed);
+        size_t space = capacity() - static_cast<size_t>(write - _read.load(std::memory_order_acquire));
+        if (count > space) count = space;
+        _copy(&_buffer[0], write, data, count, true);
+        _write.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    // Producer side: position of the next item written.
+    uint64_t writePosition() const { return _write.load(std::memory_order_relaxed); }
+
+    // Consumer side. Returns the count read.
+    size_t read(T* out, size_t count) {
+        uint64_t read = _read.load(std::memory_order_relaxed);
+        size_t available = static_cast<size_t>(_write.load(std::memory_order_acquire) - read);
+        if (count > available) count = available;
+        _copy(out, read, &_buffer[0], count, false);
+        _read.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: drop everything written before `position` (a producer
+    // writePosition()), e.g. audio rendered before a seek.
+    void skipTo(uint64_t position) {
+        uint64_t read = _read.load(std::memory_order_relaxed);
+        if (position > read) _read.store(position, std::memory_order_release);
+    }
+
+private:
+    // Copies `count` items between the ring (at running position `pos`) and a
+    // linear buffer, in at most two pieces.
+    void _copy(T* dst, uint64_t pos, const T* src, size_t count, bool intoRing) {
+        size_t start = static_cast<size_t>(pos) & _mask;
+        size_t first = count < capacity() - start ? count : capacity() - start;
+        if (intoRing) {
+            std::memcpy(dst + start, src, first * sizeof(T));
+            std::memcpy(dst, src + first, (count - first) * sizeof(T));
+        } else {
+            std::memcpy(dst, src + start, first * sizeof(T));
+            std::memcpy(dst + first, src, (count - first) * sizeof(T));
+        }
+    }
+
+    std::vector<T> _buffer;
+    size_t _mask = 0;
+    alignas(64) std::atomic<uint64_t> _write{0};
+    alignas(64) std::atomic<uint64_t> _read{0};
+};
+
+#endif // LOCK_FREE_H
@@ -0,0 +1,416 @@
+#include "mix_kernels.h"
+
+#include <cmath>
+
+#include "simd_support.h"
+
+// --- SCALAR ---
+
+static void mono_to_stereo_scalar(float* out, const float* in, int frames, float gainL, float gainR) {
+    for (int i = 0; i < frames; i++) {
+        out[i * 2] += in[i] * gainL;
+        out[i * 2 + 1] += in[i] * gainR;
+    }
+}
+
+static void stereo_to_stereo_scalar(float* out, const float* in, int frames, float gainL, float gainR) {
+    for (int i = 0; i < frames; i++) {
+        out[i * 2] += in[i * 2] * gainL;
+        out[i * 2 + 1] += in[i * 2 + 1] * gainR;
+    }
+}
+
+static void scale_scalar(float* buf, int samples, float gain) {
+    for (int i = 0; i < samples; i++) {
+        buf[i] *= gain;
+    }
+}
+
+static float peak_scalar(const float* in, int samples) {
+    float peak = 0.0f;
+    for (int i = 0; i < samples; i++) {
+        float v = std::fabs(in[i]);
+        if (v > peak) peak = v;
+    }
+    return peak;
+}
+
+// TPDF dither: the difference of the two 16-bit halves of one xorshift32
+// draw, scaled to (-1, 1) LSB. Sample i always uses lane i % 4, so the vector
+// variants produce the same noise as this one.
+static inline uint32_t xorshift32(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static const float kInt16Scale = 32767.0f;
+static const float kDitherLsb = 1.0f / 65536.0f;
+
+static inline int16_t to_int16(float v) {
+    if (v > 32767.0f) v = 32767.0f;
+    if (!(v >= -32768.0f)) v = -32768.0f; // also NaN
+    return static_cast<int16_t>(lrintf(v));
+}
+
+static void float_to_int16_scalar(int16_t* out, const float* in, int samples, MixDither* dither) {
+    if (!dither) {
+        for (int i = 0; i < samples; i++) {
+            out[i] = to_int16(in[i] * kInt16Scale);
+        }
+        return;
+    }
+    for (int i = 0; i < samples; i++) {
+        uint32_t& lane = dither->lanes[i & 3];
+        lane = xorshift32(lane);
+        int32_t d = static_cast<int32_t>(lane & 0xFFFF) - static_cast<int32_t>(lane >> 16);
+        out[i] = to_int16(in[i] * kInt16Scale + static_cast<float>(d) * kDitherLsb);
+    }
+}
+
+// --- SSE2 ---
+#if defined(SIMD_HAS_SSE2)
+
+static void mono_to_stereo_sse2(float* out, const float* in, int frames, float gainL, float gainR) {
+    const __m128 gains = _mm_setr_ps(gainL, gainR, gainL, gainR);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 m = _mm_loadu_ps(in + i);
+        __m128 lo = _mm_unpacklo_ps(m, m); // m0 m0 m1 m1
+        __m128 hi = _mm_unpackhi_ps(m, m); // m2 m2 m3 m3
+        float* o = out + i * 2;
+        _mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_mul_ps(lo, gains)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(hi, gains)));
+    }
+    mono_to_stereo_scalar(out + i * 2, in + i, frames - i, gainL, gainR);
+}
+
+static void stereo_to_stereo_sse2(float* out, const float* in, int frames, float gainL, float gainR) {
+    const __m128 gains = _mm_setr_ps(gainL, gainR, gainL, gainR);
+    int samples = frames * 2;
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(in + i), gains);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(in + i + 4), gains);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), a));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(out + i + 4), b));
+    }
+    stereo_to_stereo_scalar(out + i, in + i, (samples - i) / 2, gainL, gainR);
+}
+
+static float peak_sse2(const float* in, int samples) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 m0 = _mm_setzero_ps();
+    __m128 m1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        m0 = _mm_max_ps(m0, _mm_and_ps(_mm_loadu_ps(in + i), absMask));
+        m1 = _mm_max_ps(m1, _mm_and_ps(_mm_loadu_ps(in + i + 4), absMask));
+    }
+    m0 = _mm_max_ps(m0, m1);
+    m0 = _mm_max_ps(m0, _mm_shuffle_ps(m0, m0, _MM_SHUFFLE(1, 0, 3, 2)));
+    m0 = _mm_max_ps(m0, _mm_shuffle_ps(m0, m0, _MM_SHUFFLE(2, 3, 0, 1)));
+    float peak = _mm_cvtss_f32(m0);
+    float tail = peak_scalar(in + i, samples - i);
+    return tail > peak ? tail : peak;
+}
+
+static void scale_sse2(float* buf, int samples, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), g));
+    }
+    scale_scalar(buf + i, samples - i, gain);
+}
+
+static inline __m128 tpdf_sse2(__m128i& state) {
+    __m128i x = state;
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    state = x;
+    __m128i d = _mm_sub_epi32(_mm_and_si128(x, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(x, 16));
+    return _mm_mul_ps(_mm_cvtepi32_ps(d), _mm_set1_ps(kDitherLsb));
+}
+
+template <bool kDither>
+static void float_to_int16_sse2_impl(int16_t* out, const float* in, int samples, MixDither* dither) {
+    const __m128 scale = _mm_set1_ps(kInt16Scale);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    __m128i state = kDither ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes)) : _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(in + i + 4), scale);
+        if (kDither) {
+            a = _mm_add_ps(a, tpdf_sse2(state));
+            b = _mm_add_ps(b, tpdf_sse2(state));
+        }
+        // Clamp first: cvtps saturates to INT32_MIN on overflow either way.
+        // max(v, lo) returns lo for NaN.
+        a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+        b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    if (kDither) _mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes), state);
+    float_to_int16_scalar(out + i, in + i, samples - i, dither); // i % 4 == 0, lanes line up
+}
+
+static void float_to_int16_sse2(int16_t* out, const float* in, int samples, MixDither* dither) {
+    if (dither) {
+        float_to_int16_sse2_impl<true>(out, in, samples, dither);
+    } else {
+        float_to_int16_sse2_impl<false>(out, in, samples, nullptr);
+    }
+}
+
+#endif
+
+// --- AVX2 ---
+#if defined(SIMD_HAS_AVX2)
+
+SIMD_TARGET_AVX2
+static void mono_to_stereo_avx2(float* out, const float* in, int frames, float gainL, float gainR) {
+    const __m256 gains = _mm256_setr_ps(gainL, gainR, gainL, gainR, gainL, gainR, gainL, gainR);
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 m = _mm256_loadu_ps(in + i);
+        // unpack works per 128-bit lane: [m0 m0 m1 m1 | m4 m4 m5 m5], [m2 m2 m3 m3 | m6 m6 m7 m7]
+        __m256 lo = _mm256_unpacklo_ps(m, m);
+        __m256 hi = _mm256_unpackhi_ps(m, m);
+        __m256 first = _mm256_permute2f128_ps(lo, hi, 0x20);  // m0..m3 duplicated
+        __m256 second = _mm256_permute2f128_ps(lo, hi, 0x31); // m4..m7 duplicated
+        float* o = out + i * 2;
+        _mm256_storeu_ps(o, _mm256_add_ps(_mm256_loadu_ps(o), _mm256_mul_ps(first, gains)));
+        _mm256_storeu_ps(o + 8, _mm256_add_ps(_mm256_loadu_ps(o + 8), _mm256_mul_ps(second, gains)));
+    }
+    mono_to_stereo_sse2(out + i * 2, in + i, frames - i, gainL, gainR);
+}
+
+SIMD_TARGET_AVX2
+static void stereo_to_stereo_avx2(float* out, const float* in, int frames, float gainL, float gainR) {
+    const __m256 gains = _mm256_setr_ps(gainL, gainR, gainL, gainR, gainL, gainR, gainL, gainR);
+    int samples = frames * 2;
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(in + i), gains);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), gains);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), a));
+        _mm256_storeu_ps(out + i + 8, _mm256_add_ps(_mm256_loadu_ps(out + i + 8), b));
+    }
+    stereo_to_stereo_sse2(out + i, in + i, (samples - i) / 2, gainL, gainR);
+}
+
+SIMD_TARGET_AVX2
+static void scale_avx2(float* buf, int samples, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        _mm256_storeu_ps(buf + i, _mm256_mul_ps(_mm256_loadu_ps(buf + i), g));
+    }
+    scale_sse2(buf + i, samples - i, gain);
+}
+
+#endif
+
+// --- NEON ---
+#if defined(SIMD_HAS_NEON)
+
+static void mono_to_stereo_neon(float* out, const float* in, int frames, float gainL, float gainR) {
+    const float32x4_t gl = vdupq_n_f32(gainL);
+    const float32x4_t gr = vdupq_n_f32(gainR);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float32x4_t m = vld1q_f32(in + i);
+        float32x4x2_t o = vld2q_f32(out + i * 2); // de-interleaves L / R
+        o.val[0] = vmlaq_f32(o.val[0], m, gl);
+        o.val[1] = vmlaq_f32(o.val[1], m, gr);
+        vst2q_f32(out + i * 2, o);
+    }
+    mono_to_stereo_scalar(out + i * 2, in + i, frames - i, gainL, gainR);
+}
+
+static void stereo_to_stereo_neon(float* out, const float* in, int frames, float gainL, float gainR) {
+    const float gainArr[4] = { gainL, gainR, gainL, gainR };
+    const float32x4_t gains = vld1q_f32(gainArr);
+    int samples = frames * 2;
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), gains));
+        vst1q_f32(out + i + 4, vmlaq_f32(vld1q_f32(out + i + 4), vld1q_f32(in + i + 4), gains));
+    }
+    stereo_to_stereo_scalar(out + i, in + i, (samples - i) / 2, gainL, gainR);
+}
+
+static float peak_neon(const float* in, int samples) {
+    float32x4_t m0 = vdupq_n_f32(0.0f);
+    float32x4_t m1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        m0 = vmaxq_f32(m0, vabsq_f32(vld1q_f32(in + i)));
+        m1 = vmaxq_f32(m1, vabsq_f32(vld1q_f32(in + i + 4)));
+    }
+    m0 = vmaxq_f32(m0, m1);
+    float32x2_t m = vpmax_f32(vget_low_f32(m0), vget_high_f32(m0));
+    m = vpmax_f32(m, m);
+    float peak = vget_lane_f32(m, 0);
+    float tail = peak_scalar(in + i, samples - i);
+    return tail > peak ? tail : peak;
+}
+
+static void scale_neon(float* buf, int samples, float gain) {
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        vst1q_f32(buf + i, vmulq_n_f32(vld1q_f32(buf + i), gain));
+    }
+    scale_scalar(buf + i, samples - i, gain);
+}
+
+static inline float32x4_t tpdf_neon(uint32x4_t& state) {
+    uint32x4_t x = state;
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    x = veorq_u32(x, vshlq_n_u32(x, 5));
+    state = x;
+    int32x4_t d = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(x, vdupq_n_u32(0xFFFF))),
+                            vreinterpretq_s32_u32(vshrq_n_u32(x, 16)));
+    return vmulq_n_f32(vcvtq_f32_s32(d), kDitherLsb);
+}
+
+// Round to nearest; vcvtq truncates and vcvtnq is ARMv8 only.
+static inline int32x4_t round_neon(float32x4_t v) {
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    float32x4_t bias = vbslq_f32(vcltq_f32(v, vdupq_n_f32(0.0f)), vnegq_f32(half), half);
+    return vcvtq_s32_f32(vaddq_f32(v, bias));
+}
+
+template <bool kDither>
+static void float_to_int16_neon_impl(int16_t* out, const float* in, int samples, MixDither* dither) {
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    uint32x4_t state = kDither ? vld1q_u32(dither->lanes) : vdupq_n_u32(0);
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(in + i), kInt16Scale);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(in + i + 4), kInt16Scale);
+        if (kDither) {
+            a = vaddq_f32(a, tpdf_neon(state));
+            b = vaddq_f32(b, tpdf_neon(state));
+        }
+        a = vminq_f32(vmaxq_f32(a, lo), hi);
+        b = vminq_f32(vmaxq_f32(b, lo), hi);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(round_neon(a)), vqmovn_s32(round_neon(b))));
+    }
+    if (kDither) vst1q_u32(dither->lanes, state);
+    float_to_int16_scalar(out + i, in + i, samples - i, dither);
+}
+
+static void float_to_int16_neon(int16_t* out, const float* in, int samples, MixDither* dither) {
+    if (dither) {
+        float_to_int16_neon_impl<true>(out, in, samples, dither);
+    } else {
+        float_to_int16_neon_impl<false>(out, in, samples, nullptr);
+    }
+}
+
+#endif
+
+// --- DISPATCH ---
+
+struct MixKernelTable {
+    void (*monoToStereo)(float*, const float*, int, float, float);
+    void (*stereoToStereo)(float*, const float*, int, float, float);
+    void (*scale)(float*, int, float);
+    float (*peak)(const float*, int);
+    void (*floatToInt16)(int16_t*, const float*, int, MixDither*);
+    const char* name;
+};
+
+static MixKernelTable select_kernels() {
+#if defined(SIMD_HAS_NEON)
+    return { mono_to_stereo_neon, stereo_to_stereo_neon, scale_neon, peak_neon, float_to_int16_neon, "neon" };
+#else
+#if defined(SIMD_HAS_AVX2)
+    if (cpu_has_avx2()) {
+        return { mono_to_stereo_avx2, stereo_to_stereo_avx2, scale_avx2, peak_sse2, float_to_int16_sse2, "avx2" };
+    }
+#endif
+#if defined(SIMD_HAS_SSE2)
+    return { mono_to_stereo_sse2, stereo_to_stereo_sse2, scale_sse2, peak_sse2, float_to_int16_sse2, "sse2" };
+#else
+    return { mono_to_stereo_scalar, stereo_to_stereo_scalar, scale_scalar, peak_scalar, float_to_int16_scalar, "scalar" };
+#endif
+#endif
+}
+
+static const MixKernelTable& kernels() {
+    static const MixKernelTable table = select_kernels(); // thread-safe init, once
+    return table;
+}
+
+void mix_mono_to_stereo(float* out, const float* in, int frames, float gainL, float gainR) {
+    if (frames > 0) kernels().monoToStereo(out, in, frames, gainL, gainR);
+}
+
+void mix_stereo_to_stereo(float* out, const float* in, int frames, float gainL, float gainR) {
+    if (frames > 0) kernels().stereoToStereo(out, in, frames, gainL, gainR);
+}
+
+void mix_strided_to_stereo(float* out, const float* in, int frames, int channels, float gainL, float gainR) {
+    for (int i = 0; i < frames; i++) {
+        out[i * 2] += in[i * channels] * gainL;
+        out[i * 2 + 1] += in[i * channels + 1] * gainR;
+    }
+}
+
+float mix_apply_envelope(float* stereo, int frames, float envelope, float target, float step) {
+    int i = 0;
+
+    // Ramp section (at most 20ms after a start/seek), scalar
+    while (i < frames && envelope != target) {
+        if (envelope < target) {
+            envelope += step;
+            if (envelope > target) envelope = target;
+        } else {
+            envelope -= step;
+            if (envelope < target) envelope = target;
+        }
+        stereo[i * 2] *= envelope;
+        stereo[i * 2 + 1] *= envelope;
+        i++;
+    }
+
+    // Settled section: unity is a no-op, anything else is one vector scale
+    if (i < frames && envelope != 1.0f) {
+        kernels().scale(stereo + i * 2, (frames - i) * 2, envelope);
+    }
+    return envelope;
+}
+
+float mix_peak(const float* in, int samples) {
+    return samples > 0 ? kernels().peak(in, samples) : 0.0f;
+}
+
+void mix_dither_init(MixDither* dither, uint32_t seed) {
+    for (int lane = 0; lane < 4; lane++) {
+        // splitmix-style spread so nearby seeds give unrelated lanes; xorshift
+        // state must be non-zero
+        uint32_t x = seed + 0x9E3779B9u * static_cast<uint32_t>(lane + 1);
+        x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+        x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+        x ^= x >> 16;
+        dither->lanes[lane] = x ? x : 0x6D2B79F5u;
+    }
+}
+
+void mix_float_to_int16(int16_t* out, const float* in, int samples, MixDither* dither) {
+    if (samples > 0) kernels().floatToInt16(out, in, samples, dither);
+}
+
+const char* mix_kernel_name() {
+    return kernels().name;
+}
@@ -0,0 +1,47 @@
+#ifndef MIX_KERNELS_H
+#define MIX_KERNELS_H
+
+#include <cstdint>
+
+// --- MIXING KERNELS ---
+// Block-oriented accumulate kernels used by LiveMixer. Each call handles one
+// contiguous run of frames for one track, with gains resolved up front, so the
+// inner loops have no branches and vectorize cleanly.
+//
+// Variants: scalar, SSE2, AVX2 (x86, selected at runtime) and NEON (ARM).
+// The best available variant is picked once on first use.
+
+// out[2i] += in[i] * gainL, out[2i+1] += in[i] * gainR
+void mix_mono_to_stereo(float* out, const float* in, int frames, float gainL, float gainR);
+
+// out[2i] += in[2i] * gainL, out[2i+1] += in[2i+1] * gainR
+void mix_stereo_to_stereo(float* out, const float* in, int frames, float gainL, float gainR);
+
+// Fallback for interleaved sources with more than two channels (uses the first two).
+void mix_strided_to_stereo(float* out, const float* in, int frames, int channels, float gainL, float gainR);
+
+// Master click-prevention envelope over an interleaved stereo buffer.
+// Moves `envelope` towards `target` by `step` per frame and returns the new value.
+// Once the envelope has settled the rest of the block is a single SIMD scale
+// (or nothing at all when settled at unity).
+float mix_apply_envelope(float* stereo, int frames, float envelope, float target, float step);
+
+// max |in[i]| over `samples` floats (e.g. a block of interleaved frames).
+float mix_peak(const float* in, int samples);
+
+// TPDF dither source for mix_float_to_int16: four xorshift32 lanes, one per
+// SIMD lane, so the vector paths need no multiplies.
+struct MixDither {
+    uint32_t lanes[4];
+};
+
+void mix_dither_init(MixDither* dither, uint32_t seed);
+
+// out[i] = clamp(round(in[i] * 32767 + d)), d triangular in (-1, 1) LSB when
+// `dither` is set, 0 otherwise.
+void mix_float_to_int16(int16_t* out, const float* in, int samples, MixDither* dither);
+
+// Name of the selected variant, for logging.
+const char* mix_kernel_name();
+
+#endif // MIX_KERNELS_H
@@ -0,0 +1,290 @@
+#include "pv_kernels.h"
+
+#include <cmath>
+
+#include "simd_support.h"
+
+namespace pv_generic {
+
+#include "pv_kernels_impl.h"
+
+// --- SCALAR ---
+
+struct Scalar {
+    typedef float F;
+    typedef bool M;
+    static const int kWidth = 1;
+
+    static F set(float v) { return v; }
+    static F load(const float* p) { return *p; }
+    static void store(float* p, F v) { *p = v; }
+    static void loadComplex(const float* p, F& re, F& im) { re = p[0]; im = p[1]; }
+    static void storeComplex(float* p, F re, F im) { p[0] = re; p[1] = im; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F div(F a, F b) { return a / b; }
+    static F sqrt(F a) { return std::sqrt(a); }
+    static F min(F a, F b) { return a < b ? a : b; }
+    static F max(F a, F b) { return a > b ? a : b; }
+    static F abs(F a) { return std::fabs(a); }
+    static F neg(F a) { return -a; }
+    static F round(F a) { return rintf(a); }
+    static M gt(F a, F b) { return a > b; }
+    static M lt(F a, F b) { return a < b; }
+    static M orMask(M a, M b) { return a || b; }
+    static F select(M m, F a, F b) { return m ? a : b; }
+    static float hsum(F a) { return a; }
+    static F ramp(float start) { return start; }
+};
+
+// --- SSE2 ---
+#if defined(SIMD_HAS_SSE2)
+
+struct Sse2 {
+    typedef __m128 F;
+    typedef __m128 M;
+    static const int kWidth = 4;
+
+    static F set(float v) { return _mm_set1_ps(v); }
+    static F load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+    static void loadComplex(const float* p, F& re, F& im) {
+        __m128 a = _mm_loadu_ps(p);     // r0 i0 r1 i1
+        __m128 b = _mm_loadu_ps(p + 4); // r2 i2 r3 i3
+        re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static void storeComplex(float* p, F re, F im) {
+        _mm_storeu_ps(p, _mm_unpacklo_ps(re, im));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(re, im));
+    }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm_div_ps(a, b); }
+    static F sqrt(F a) { return _mm_sqrt_ps(a); }
+    static F min(F a, F b) { return _mm_min_ps(a, b); }
+    static F max(F a, F b) { return _mm_max_ps(a, b); }
+    static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static F neg(F a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static F round(F a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); } // |a| < 2^31
+    static M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+    static M lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+    static M orMask(M a, M b) { return _mm_or_ps(a, b); }
+    static F select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static float hsum(F a) {
+        __m128 t = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        t = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+        return _mm_cvtss_f32(t);
+    }
+    static F ramp(float start) { return _mm_setr_ps(start, start + 1.0f, start + 2.0f, start + 3.0f); }
+};
+
+#endif
+
+// --- NEON ---
+#if defined(SIMD_HAS_NEON)
+
+struct Neon {
+    typedef float32x4_t F;
+    typedef uint32x4_t M;
+    static const int kWidth = 4;
+
+    static F set(float v) { return vdupq_n_f32(v); }
+    static F load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, F v) { vst1q_f32(p, v); }
+    static void loadComplex(const float* p, F& re, F& im) {
+        float32x4x2_t v = vld2q_f32(p); // de-interleaves re / im
+        re = v.val[0];
+        im = v.val[1];
+    }
+    static void storeComplex(float* p, F re, F im) {
+        float32x4x2_t v;
+        v.val[0] = re;
+        v.val[1] = im;
+        vst2q_f32(p, v);
+    }
+    static F add(F a, F b) { return vaddq_f32(a, b); }
+    static F sub(F a, F b) { return vsubq_f32(a, b); }
+    static F mul(F a, F b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+    static F div(F a, F b) { return vdivq_f32(a, b); }
+    static F sqrt(F a) { return vsqrtq_f32(a); }
+    static F round(F a) { return vrndnq_f32(a); }
+#else
+    // ARMv7 has no vector divide, square root or round to nearest: estimates
+    // refined by two Newton steps, and a biased truncation
+    static F div(F a, F b) {
+        float32x4_t r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+    }
+    static F sqrt(F a) {
+        float32x4_t e = vrsqrteq_f32(a);
+        e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, e), e), e);
+        e = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, e), e), e);
+        return vbslq_f32(vcgtq_f32(a, vdupq_n_f32(0.0f)), vmulq_f32(a, e), vdupq_n_f32(0.0f));
+    }
+    static F round(F a) {
+        float32x4_t bias = vbslq_f32(vcltq_f32(a, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+        return vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a, bias)));
+    }
+#endif
+    static F min(F a, F b) { return vminq_f32(a, b); }
+    static F max(F a, F b) { return vmaxq_f32(a, b); }
+    static F abs(F a) { return vabsq_f32(a); }
+    static F neg(F a) { return vnegq_f32(a); }
+    static M gt(F a, F b) { return vcgtq_f32(a, b); }
+    static M lt(F a, F b) { return vcltq_f32(a, b); }
+    static M orMask(M a, M b) { return vorrq_u32(a, b); }
+    static F select(M m, F a, F b) { return vbslq_f32(m, a, b); }
+    static float hsum(F a) {
+        float32x2_t t = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+        return vget_lane_f32(vpadd_f32(t, t), 0);
+    }
+    static F ramp(float start) {
+        const float v[4] = { start, start + 1.0f, start + 2.0f, start + 3.0f };
+        return vld1q_f32(v);
+    }
+};
+
+#endif
+
+} // namespace pv_generic
+
+// --- AVX2 ---
+// A second copy of the generic kernels compiled for AVX2, so the traits below
+// inline into them. Only reached after cpu_has_avx2().
+#if defined(SIMD_HAS_AVX2)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace pv_avx2 {
+
+#include "pv_kernels_impl.h"
+
+struct Avx2 {
+    typedef __m256 F;
+    typedef __m256 M;
+    static const int kWidth = 8;
+
+    static F set(float v) { return _mm256_set1_ps(v); }
+    static F load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static void loadComplex(const float* p, F& re, F& im) {
+        __m256 a = _mm256_loadu_ps(p);     // r0 i0 .. r3 i3
+        __m256 b = _mm256_loadu_ps(p + 8); // r4 i4 .. r7 i7
+        // per 128-bit lane: [r0 r1 r4 r5 | r2 r3 r6 r7], then restore the order
+        __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 i = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+        im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(i), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    static void storeComplex(float* p, F re, F im) {
+        __m256 lo = _mm256_unpacklo_ps(re, im); // [r0 i0 r1 i1 | r4 i4 r5 i5]
+        __m256 hi = _mm256_unpackhi_ps(re, im); // [r2 i2 r3 i3 | r6 i6 r7 i7]
+        _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm256_div_ps(a, b); }
+    static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static F min(F a, F b) { return _mm256_min_ps(a, b); }
+    static F max(F a, F b) { return _mm256_max_ps(a, b); }
+    static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static F neg(F a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static F round(F a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static M lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M orMask(M a, M b) { return _mm256_or_ps(a, b); }
+    static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+    static float hsum(F a) {
+        __m128 t = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        t = _mm_add_ps(t, _mm_movehl_ps(t, t));
+        t = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+        return _mm_cvtss_f32(t);
+    }
+    static F ramp(float start) {
+        return _mm256_add_ps(_mm256_set1_ps(start), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+};
+
+static float analyze(const float* spectrum, float* magnitude, float* phase, int bins) {
+    return pv_analyze_all<Avx2, pv_generic::Scalar>(spectrum, magnitude, phase, bins);
+}
+
+static void advance(float* spectrum, const float* magnitude, const float* phase, float* lastPhase,
+                    float* sumPhase, int bins, float analysisAdvance, float synthesisAdvance, float hopRatio) {
+    pv_advance_all<Avx2, pv_generic::Scalar>(spectrum, magnitude, phase, lastPhase, sumPhase, bins,
+                                             analysisAdvance, synthesisAdvance, hopRatio);
+}
+
+} // namespace pv_avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
+
+// --- DISPATCH ---
+
+typedef float (*PvAnalyzeFn)(const float*, float*, float*, int);
+typedef void (*PvAdvanceFn)(float*, const float*, const float*, float*, float*, int, float, float, float);
+
+struct PvKernelTable {
+    PvAnalyzeFn analyze;
+    PvAdvanceFn advance;
+    const char* name;
+};
+
+static PvKernelTable select_kernels() {
+    using namespace pv_generic;
+#if defined(SIMD_HAS_NEON)
+    return { pv_analyze_all<Neon, Scalar>, pv_advance_all<Neon, Scalar>, "neon" };
+#else
+#if defined(SIMD_HAS_AVX2)
+    if (cpu_has_avx2()) {
+        return { pv_avx2::analyze, pv_avx2::advance, "avx2" };
+    }
+#endif
+#if defined(SIMD_HAS_SSE2)
+    return { pv_analyze_all<Sse2, Scalar>, pv_advance_all<Sse2, Scalar>, "sse2" };
+#else
+    return { pv_analyze_all<Scalar, Scalar>, pv_advance_all<Scalar, Scalar>, "scalar" };
+#endif
+#endif
+}
+
+static const PvKernelTable& kernels() {
+    static const PvKernelTable table = select_kernels(); // thread-safe init, once
+    return table;
+}
+
+float pv_analyze(const float* spectrum, float* magnitude, float* phase, int bins) {
+    return bins > 0 ? kernels().analyze(spectrum, magnitude, phase, bins) : 0.0f;
+}
+
+void pv_advance(float* spectrum, const float* magnitude, const float* phase,
+                float* lastPhase, float* sumPhase, int bins,
+                float analysisAdvance, float synthesisAdvance, float hopRatio) {
+    if (bins > 0) {
+        kernels().advance(spectrum, magnitude, phase, lastPhase, sumPhase, bins,
+                          analysisAdvance, synthesisAdvance, hopRatio);
+    }
+}
+
+const char* pv_kernel_name() {
+    return kernels().name;
+}
@@ -0,0 +1,33 @@
+#ifndef PV_KERNELS_H
+#define PV_KERNELS_H
+
+// --- PHASE VOCODER KERNELS ---
+// Per-bin work of Vocoder::_processChannel over the N/2+1 bins of a real FFT.
+// Spectra are interleaved (re, im) floats, the kiss_fft_cpx layout. Every bin
+// is independent, so the loops are plain SIMD with no libm calls:
+//   atan2:    7th-order odd polynomial on [0, 1] plus octant fix-up,
+//             |error| < 2e-6 rad
+//   sin, cos: Cephes polynomials on [-pi/4, pi/4] after quadrant reduction,
+//             |error| < 2e-7 for arguments in [-pi, pi]
+//   wrap:     x - 2pi * round(x / 2pi), branch-free
+//
+// Variants: scalar, SSE2, AVX2 (x86, selected at runtime) and NEON (ARM).
+
+// magnitude[k] = |X[k]|, phase[k] = arg X[k] in [-pi, pi].
+// Returns the frame energy, sum of |X[k]|^2.
+float pv_analyze(const float* spectrum, float* magnitude, float* phase, int bins);
+
+// Phase-vocoder advance and resynthesis, for each bin k:
+//   deviation   = wrap(phase[k] - lastPhase[k] - k * analysisAdvance)
+//   sumPhase[k] = wrap(sumPhase[k] + k * synthesisAdvance + deviation * hopRatio)
+//   X[k]        = magnitude[k] * (cos, sin)(sumPhase[k])
+//   lastPhase[k] = phase[k]
+// The advances are 2pi * hop / N, hopRatio is hopOut / hopIn.
+void pv_advance(float* spectrum, const float* magnitude, const float* phase,
+                float* lastPhase, float* sumPhase, int bins,
+                float analysisAdvance, float synthesisAdvance, float hopRatio);
+
+// Name of the selected variant, for logging.
+const char* pv_kernel_name();
+
+#endif // PV_KERNELS_H
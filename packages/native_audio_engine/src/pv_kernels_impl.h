@@ -0,0 +1,131 @@
+// Generic phase-vocoder bin kernels over a traits type V: one SIMD width with
+// F (float vector), M (compare mask), kWidth and the ops used below.
+// pv_kernels.cpp includes this once per instruction set, each time inside its
+// own namespace (the AVX2 copy inside a target region), hence no guard.
+
+static const float kPvPi = 3.14159265358979f;
+static const float kPvHalfPi = 1.57079632679490f;
+static const float kPvTwoPi = 6.28318530717959f;
+static const float kPvInvTwoPi = 0.159154943091895f;
+static const float kPvTwoOverPi = 0.636619772367581f;
+// pi/2 split in two for the quadrant reduction (Cody-Waite)
+static const float kPvHalfPiHi = 1.5707963705062866f;
+static const float kPvHalfPiLo = -4.371139000186243e-8f;
+
+template <class V>
+static inline typename V::F pv_wrap(typename V::F x) {
+    typename V::F turns = V::round(V::mul(x, V::set(kPvInvTwoPi)));
+    return V::sub(x, V::mul(turns, V::set(kPvTwoPi)));
+}
+
+template <class V>
+static inline typename V::F pv_atan2(typename V::F y, typename V::F x) {
+    typedef typename V::F F;
+    F ax = V::abs(x);
+    F ay = V::abs(y);
+    // z = min / max in [0, 1]; 0 / 0 at the origin becomes 0
+    F z = V::div(V::min(ax, ay), V::max(V::max(ax, ay), V::set(1e-30f)));
+    F z2 = V::mul(z, z);
+    F p = V::set(-0.01172120f);
+    p = V::add(V::mul(p, z2), V::set(0.05265332f));
+    p = V::add(V::mul(p, z2), V::set(-0.11643287f));
+    p = V::add(V::mul(p, z2), V::set(0.19354346f));
+    p = V::add(V::mul(p, z2), V::set(-0.33262347f));
+    p = V::add(V::mul(p, z2), V::set(0.99997726f));
+    F a = V::mul(z, p);
+    a = V::select(V::gt(ay, ax), V::sub(V::set(kPvHalfPi), a), a);
+    a = V::select(V::lt(x, V::set(0.0f)), V::sub(V::set(kPvPi), a), a);
+    return V::select(V::lt(y, V::set(0.0f)), V::neg(a), a);
+}
+
+// x in [-pi, pi] (quadrants -2..2)
+template <class V>
+static inline void pv_sincos(typename V::F x, typename V::F& s, typename V::F& c) {
+    typedef typename V::F F;
+    typedef typename V::M M;
+    F q = V::round(V::mul(x, V::set(kPvTwoOverPi)));
+    F r = V::sub(V::sub(x, V::mul(q, V::set(kPvHalfPiHi))), V::mul(q, V::set(kPvHalfPiLo)));
+    F r2 = V::mul(r, r);
+
+    F ps = V::set(-1.9515295891e-4f);
+    ps = V::add(V::mul(ps, r2), V::set(8.3321608736e-3f));
+    ps = V::add(V::mul(ps, r2), V::set(-1.6666654611e-1f));
+    ps = V::add(V::mul(V::mul(ps, r2), r), r);
+
+    F pc = V::set(2.443315711809948e-5f);
+    pc = V::add(V::mul(pc, r2), V::set(-1.388731625493765e-3f));
+    pc = V::add(V::mul(pc, r2), V::set(4.166664568298827e-2f));
+    pc = V::add(V::mul(V::mul(pc, r2), r2), V::sub(V::set(1.0f), V::mul(r2, V::set(0.5f))));
+
+    // Odd quadrants swap sin and cos; signs follow the quadrant
+    M odd = V::lt(V::abs(V::sub(V::abs(q), V::set(1.0f))), V::set(0.5f));
+    F sv = V::select(odd, pc, ps);
+    F cv = V::select(odd, ps, pc);
+    M sinNeg = V::orMask(V::lt(q, V::set(-0.5f)), V::gt(q, V::set(1.5f)));
+    M cosNeg = V::orMask(V::gt(q, V::set(0.5f)), V::lt(q, V::set(-1.5f)));
+    s = V::select(sinNeg, V::neg(sv), sv);
+    c = V::select(cosNeg, V::neg(cv), cv);
+}
+
+// Bins [begin, end); the count must be a multiple of V::kWidth.
+template <class V>
+static float pv_analyze_range(const float* spectrum, float* magnitude, float* phase, int begin, int end) {
+    typedef typename V::F F;
+    F energy = V::set(0.0f);
+    for (int k = begin; k < end; k += V::kWidth) {
+        F re, im;
+        V::loadComplex(spectrum + 2 * k, re, im);
+        F power = V::add(V::mul(re, re), V::mul(im, im));
+        energy = V::add(energy, power);
+        V::store(magnitude + k, V::sqrt(power));
+        V::store(phase + k, pv_atan2<V>(im, re));
+    }
+    return V::hsum(energy);
+}
+
+template <class V>
+static void pv_advance_range(float* spectrum, const float* magnitude, const float* phase,
+                             float* lastPhase, float* sumPhase, int begin, int end,
+                             float analysisAdvance, float synthesisAdvance, float hopRatio) {
+    typedef typename V::F F;
+    const F analysis = V::set(analysisAdvance);
+    const F synthesis = V::set(synthesisAdvance);
+    const F ratio = V::set(hopRatio);
+    const F step = V::set(static_cast<float>(V::kWidth));
+    F bin = V::ramp(static_cast<float>(begin));
+    for (int k = begin; k < end; k += V::kWidth) {
+        F current = V::load(phase + k);
+        F deviation = pv_wrap<V>(V::sub(V::sub(current, V::load(lastPhase + k)), V::mul(bin, analysis)));
+        V::store(lastPhase + k, current);
+
+        F sum = V::add(V::load(sumPhase + k), V::add(V::mul(bin, synthesis), V::mul(deviation, ratio)));
+        sum = pv_wrap<V>(sum);
+        V::store(sumPhase + k, sum);
+
+        F s, c;
+        pv_sincos<V>(sum, s, c);
+        F mag = V::load(magnitude + k);
+        V::storeComplex(spectrum + 2 * k, V::mul(mag, c), V::mul(mag, s));
+        bin = V::add(bin, step);
+    }
+}
+
+// Whole spectrum: full vectors of V, then the remaining bins (N/2+1 is odd)
+// with Tail.
+template <class V, class Tail>
+static float pv_analyze_all(const float* spectrum, float* magnitude, float* phase, int bins) {
+    int end = bins - bins % V::kWidth;
+    return pv_analyze_range<V>(spectrum, magnitude, phase, 0, end)
+         + pv_analyze_range<Tail>(spectrum, magnitude, phase, end, bins);
+}
+
+template <class V, class Tail>
+static void pv_advance_all(float* spectrum, const float* magnitude, const float* phase,
+                           float* lastPhase, float* sumPhase, int bins,
+                           float analysisAdvance, float synthesisAdvance, float hopRatio) {
+    int end = bins - bins % V::kWidth;
+    pv_advance_range<V>(spectrum, magnitude, phase, lastPhase, sumPhase, 0, end,
+                        analysisAdvance, synthesisAdvance, hopRatio);
+    pv_advance_range<Tail>(spectrum, magnitude, phase, lastPhase, sumPhase, end, bins,
+                           analysisAdvance, synthesisAdvance, hopRatio);
+}
@@ -0,0 +1,154 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const int kHalfTaps = 32;         // per side, at the narrower of the two rates
+static const double kKaiserBeta = 8.6;   // ~-90 dB stopband
+static const double kCutoff = 0.94;      // passband edge, fraction of the lower Nyquist
+static const double kPi = 3.14159265358979323846;
+
+static int gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth order modified Bessel function of the first kind (Kaiser window).
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+Resampler::Resampler(int inRate, int outRate, int channels) : _channels(channels) {
+    int g = gcd(inRate, outRate);
+    _up = outRate / g;
+    _down = inRate / g;
+
+    // Downsampling lowers the cutoff below the input Nyquist, so the filter gets
+    // proportionally longer to keep the same transition band.
+    double ratio = std::min(1.0, static_cast<double>(_up) / _down);
+    double cutoff = kCutoff * ratio;
+    _halfTaps = static_cast<int>(std::ceil(kHalfTaps / ratio));
+    _numPhases = std::min(_up, kMaxPhases);
+
+    int taps = 2 * _halfTaps;
+    double windowNorm = besselI0(kKaiserBeta);
+    _filters.resize(static_cast<size_t>(_numPhases) * taps);
+    for (int p = 0; p < _numPhases; p++) {
+        double frac = static_cast<double>(p) / _numPhases;
+        float* h = &_filters[static_cast<size_t>(p) * taps];
+        double sum = 0.0;
+        for (int k = 0; k < taps; k++) {
+            // distance from the output instant to input sample (center - halfTaps + 1 + k)
+            double d = frac + _halfTaps - 1 - k;
+            double x = d / _halfTaps;
+            double window = std::fabs(x) < 1.0 ? besselI0(kKaiserBeta * std::sqrt(1.0 - x * x)) / windowNorm : 0.0;
+            double arg = kPi * cutoff * d;
+            double sinc = std::fabs(arg) < 1e-9 ? 1.0 : std::sin(arg) / arg;
+            double value = cutoff * sinc * window;
+            h[k] = static_cast<float>(value);
+            sum += value;
+        }
+        // Unity gain at DC for every phase
+        for (int k = 0; k < taps; k++) {
+            h[k] = static_cast<float>(h[k] / sum);
+        }
+    }
+
+    // Prime with silence so the first output lines up with input frame 0
+    _bufferStart = -(_halfTaps - 1);
+    _buffer.assign(static_cast<size_t>(_halfTaps - 1) * _channels, 0.0f);
+}
+
+int64_t Resampler::outputLength(int64_t inFrames, int inRate, int outRate) {
+    int g = gcd(inRate, outRate);
+    int64_t up = outRate / g;
+    int64_t down = inRate / g;
+    return (inFrames * up + down - 1) / down;
+}
+
+int64_t Resampler::maxOutput(int64_t inFrames) const {
+    return (inFrames + 2 * _halfTaps) * _up / _down + 2;
+}
+
+int64_t Resampler::process(const float* in, int64_t inFrames, float* out) {
+    _buffer.insert(_buffer.end(), in, in + inFrames * _channels);
+    _inputFrames += inFrames;
+    return _run(out, INT64_MAX);
+}
+
+int64_t Resampler::flush(float* out) {
+    _buffer.resize(_buffer.size() + static_cast<size_t>(_halfTaps) * _channels, 0.0f);
+    return _run(out, _inputFrames);
+}
+
+int64_t Resampler::_run(float* out, int64_t limit) {
+    const int taps = 2 * _halfTaps;
+    const int64_t bufferEnd = _bufferStart + static_cast<int64_t>(_buffer.size()) / _channels;
+    int64_t written = 0;
+
+    while (_center < limit && _center + _halfTaps < bufferEnd) {
+        const float* x = _buffer.data() + (_center - _halfTaps + 1 - _bufferStart) * _channels;
+        int64_t phaseIndex = static_cast<int64_t>(_phase) * _numPhases / _up;
+        const float* h = &_filters[static_cast<size_t>(phaseIndex) * taps];
+        float* y = out + written * _channels;
+
+        if (_channels == 1) {
+            float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+            int k = 0;
+            for (; k + 4 <= taps; k += 4) {
+                a0 += h[k] * x[k];
+                a1 += h[k + 1] * x[k + 1];
+                a2 += h[k + 2] * x[k + 2];
+                a3 += h[k + 3] * x[k + 3];
+            }
+            for (; k < taps; k++) a0 += h[k] * x[k];
+            y[0] = (a0 + a1) + (a2 + a3);
+        } else if (_channels == 2) {
+            float l0 = 0.0f, r0 = 0.0f, l1 = 0.0f, r1 = 0.0f;
+            int k = 0;
+            for (; k + 2 <= taps; k += 2) {
+                l0 += h[k] * x[k * 2];
+                r0 += h[k] * x[k * 2 + 1];
+                l1 += h[k + 1] * x[k * 2 + 2];
+                r1 += h[k + 1] * x[k * 2 + 3];
+            }
+            for (; k < taps; k++) {
+                l0 += h[k] * x[k * 2];
+                r0 += h[k] * x[k * 2 + 1];
+            }
+            y[0] = l0 + l1;
+            y[1] = r0 + r1;
+        } else {
+            for (int c = 0; c < _channels; c++) {
+                float acc = 0.0f;
+                for (int k = 0; k < taps; k++) acc += h[k] * x[k * _channels + c];
+                y[c] = acc;
+            }
+        }
+        written++;
+
+        _phase += _down;
+        _center += _phase / _up;
+        _phase %= _up;
+    }
+
+    // Keep only the history the next output still needs
+    int64_t consumed = _center - _halfTaps + 1 - _bufferStart;
+    if (consumed > 0) {
+        size_t samples = std::min(static_cast<size_t>(consumed) * _channels, _buffer.size());
+        _buffer.erase(_buffer.begin(), _buffer.begin() + samples);
+        _bufferStart += static_cast<int64_t>(samples) / _channels;
+    }
+    return written;
+}
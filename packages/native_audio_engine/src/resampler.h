@@ -0,0 +1,53 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+// --- POLYPHASE RESAMPLER ---
+// Offline sample rate conversion of interleaved float tracks, used once per
+// track at load so the device can run at its native rate without miniaudio
+// resampling every callback.
+//
+// Kaiser-windowed sinc, 32 taps per phase (more when downsampling, so the
+// transition band stays put), ~-90 dB stopband. The ratio is reduced to L/M
+// and run as an exact L-phase filter bank; ratios with more than kMaxPhases
+// phases (exotic rates) round the phase to the nearest of kMaxPhases.
+//
+// Streaming: feed input in chunks of any size, then flush() once. The output
+// is aligned with the input (no filter delay) and exactly
+// outputLength(inputFrames) frames long.
+class Resampler {
+public:
+    static constexpr int kMaxPhases = 1024;
+
+    Resampler(int inRate, int outRate, int channels);
+
+    // Frames produced for `inFrames` input frames once flushed.
+    static int64_t outputLength(int64_t inFrames, int inRate, int outRate);
+    // Upper bound of the frames a process() call with `inFrames` can write.
+    int64_t maxOutput(int64_t inFrames) const;
+
+    // Consumes `inFrames` frames; returns the number of frames written to `out`.
+    int64_t process(const float* in, int64_t inFrames, float* out);
+    // Writes the remaining frames (the filter tail, zero padded) to `out`.
+    int64_t flush(float* out);
+
+private:
+    int64_t _run(float* out, int64_t limit);
+
+    int _channels;
+    int _up;   // L
+    int _down; // M
+    int _halfTaps;
+    int _numPhases;
+    std::vector<float> _filters; // _numPhases x (2 * _halfTaps)
+
+    std::vector<float> _buffer; // pending input, interleaved
+    int64_t _bufferStart;       // input index of _buffer[0] (negative while priming)
+    int64_t _inputFrames = 0;   // total input consumed so far
+    int64_t _center = 0;        // integer input position of the next output
+    int _phase = 0;             // fractional position of the next output, in 1/L
+};
+
+#endif // RESAMPLER_H
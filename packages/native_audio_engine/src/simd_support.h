@@ -0,0 +1,49 @@
+#ifndef SIMD_SUPPORT_H
+#define SIMD_SUPPORT_H
+
+// --- SIMD SUPPORT ---
+// Instruction sets the kernel files (mix_kernels.cpp, pv_kernels.cpp) can
+// build variants for. NEON and SSE2 are baseline where available; AVX2
+// variants are compiled per function (SIMD_TARGET_AVX2) and must only be
+// selected when cpu_has_avx2() says so.
+
+#if defined(__aarch64__) || defined(_M_ARM64) || (defined(__ARM_NEON) && defined(__arm__))
+#define SIMD_HAS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SIMD_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define SIMD_HAS_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+static inline bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS saves YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#endif // SIMD_SUPPORT_H
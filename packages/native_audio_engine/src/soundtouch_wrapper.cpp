@@ -41,6 +41,10 @@ extern "C" {
         static_cast<SoundTouch*>(st)->setSetting(settingId, value);
     }
 
+    int soundtouch_getSetting(void* st, int settingId) {
+        return static_cast<SoundTouch*>(st)->getSetting(settingId);
+    }
+
     void soundtouch_putSamples(void* st, const float* samples, int numSamples) {
         static_cast<SoundTouch*>(st)->putSamples(samples, numSamples);
     }
@@ -60,4 +64,8 @@ extern "C" {
     int soundtouch_numSamples(void* st) {
         return static_cast<SoundTouch*>(st)->numSamples();
     }
+
+    int soundtouch_numUnprocessedSamples(void* st) {
+        return static_cast<SoundTouch*>(st)->numUnprocessedSamples();
+    }
 }
@@ -24,6 +24,7 @@ extern "C" {
     
     // Internal WSOLA Tuning
     EXPORT void soundtouch_setSetting(void* st, int settingId, int value);
+    EXPORT int soundtouch_getSetting(void* st, int settingId);
     
     // Processing
     // Puts samples into the pipeline.
@@ -42,6 +43,9 @@ extern "C" {
     
     // Returns number of samples currently in the pipeline.
     EXPORT int soundtouch_numSamples(void* st);
+
+    // Returns number of input samples not yet processed.
+    EXPORT int soundtouch_numUnprocessedSamples(void* st);
 }
 
 #endif // SOUNDTOUCH_WRAPPER_H
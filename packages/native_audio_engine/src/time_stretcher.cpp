@@ -0,0 +1,89 @@
+#include "time_stretcher.h"
+#include "soundtouch_wrapper.h"
+#include "Vocoder.h"
+
+// SoundTouch.h setting ids read back for the lead estimate.
+static const int kSettingSeekWindowMs = 4;
+static const int kSettingNominalOutputSequence = 7;
+// Seek window SoundTouch picks on its own when the setting is left on auto.
+static const double kAutoSeekWindowMs = 20.0;
+
+// --- SOUNDTOUCH ---
+
+class SoundTouchStretcher : public TimeStretcher {
+public:
+    SoundTouchStretcher(int sampleRate, int channels) : _sampleRate(sampleRate) {
+        _st = soundtouch_create();
+        soundtouch_setSampleRate(_st, sampleRate);
+        soundtouch_setChannels(_st, channels);
+        soundtouch_setTempo(_st, 1.0f);
+    }
+    ~SoundTouchStretcher() override { soundtouch_destroy(_st); }
+
+    void setTempo(float tempo) override { soundtouch_setTempo(_st, tempo); }
+    void setSetting(int settingId, int value) override { soundtouch_setSetting(_st, settingId, value); }
+    void putSamples(const float* samples, int numFrames) override { soundtouch_putSamples(_st, samples, numFrames); }
+    int receiveSamples(float* output, int maxFrames) override { return soundtouch_receiveSamples(_st, output, maxFrames); }
+    void flush() override { soundtouch_flush(_st); }
+    void clear() override { soundtouch_clear(_st); }
+    int numSamples() override { return soundtouch_numSamples(_st); }
+    int numUnprocessedSamples() override { return soundtouch_numUnprocessedSamples(_st); }
+
+    // WSOLA plays each sequence at 1x from a searched offset, so what comes
+    // out runs ahead by about half a sequence times (1 - tempo) plus half the
+    // seek window.
+    double lead(float tempo) override {
+        int seekWindowMs = soundtouch_getSetting(_st, kSettingSeekWindowMs);
+        double seekWindow = (seekWindowMs > 0 ? seekWindowMs : kAutoSeekWindowMs) * _sampleRate / 1000.0;
+        return startLead(tempo) + 0.5 * seekWindow;
+    }
+
+    // TDStretch skips half a seek window of input on its first sequence,
+    // which cancels that term.
+    double startLead(float tempo) override {
+        double sequence = soundtouch_getSetting(_st, kSettingNominalOutputSequence);
+        return 0.5 * sequence * (1.0 - tempo);
+    }
+
+private:
+    void* _st;
+    int _sampleRate;
+};
+
+// --- VOCODER ---
+
+class VocoderStretcher : public TimeStretcher {
+public:
+    VocoderStretcher(int sampleRate, int channels, const VocoderFrame& frame)
+        : _vocoder(sampleRate, channels,
+                   frame.fftSize > 0 ? frame.fftSize : Vocoder::kDefaultFftSize,
+                   frame.overlap > 0 ? frame.overlap : Vocoder::kDefaultOverlap) {}
+
+    void setTempo(float tempo) override { _vocoder.setTempo(tempo); }
+    void putSamples(const float* samples, int numFrames) override { _vocoder.putSamples(samples, numFrames); }
+    int receiveSamples(float* output, int maxFrames) override { return _vocoder.receiveSamples(output, maxFrames); }
+    void flush() override { _vocoder.flush(); }
+    void clear() override { _vocoder.clear(); }
+    int numSamples() override { return _vocoder.numSamples(); }
+    int numUnprocessedSamples() override { return _vocoder.numUnprocessedSamples(); }
+
+    // Analysis frames start tempo * hop apart and are resynthesized hop apart,
+    // both from frame 0, so the output at a frame's centre plays source half
+    // a frame times (1 - tempo) ahead, from the first frame on.
+    double lead(float tempo) override { return startLead(tempo); }
+    double startLead(float tempo) override { return 0.5 * _vocoder.frameSize() * (1.0 - tempo); }
+
+private:
+    Vocoder _vocoder;
+};
+
+TimeStretcher* TimeStretcher::create(int engine, int sampleRate, int channels, const VocoderFrame& frame) {
+    switch (engine) {
+        case kStretchEngineSoundTouch:
+            return new SoundTouchStretcher(sampleRate, channels);
+        case kStretchEngineVocoder:
+            return new VocoderStretcher(sampleRate, channels, frame);
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef TIME_STRETCHER_H
+#define TIME_STRETCHER_H
+
+enum StretchEngine {
+    kStretchEngineSoundTouch = 0, // WSOLA (the default)
+    kStretchEngineVocoder = 1,    // phase vocoder
+    kStretchEngineBypass = 2,     // no stretching: plays at 1x whatever the tempo
+};
+static constexpr int kNumStretchEngines = 3;
+
+// Analysis frame of the Vocoder engine: FFT size and overlap (hop = fftSize /
+// overlap), rounded as Vocoder does. 0 keeps its default.
+struct VocoderFrame {
+    int fftSize = 0;
+    int overlap = 0;
+};
+
+// --- TIME STRETCHER ---
+// The streaming interface LiveMixer drives every stretch engine through:
+// interleaved float frames in, the same material at another tempo (pitch
+// kept) out. Not thread-safe; one owner at a time.
+class TimeStretcher {
+public:
+    // A stretcher at tempo 1, or nullptr for kStretchEngineBypass (and
+    // anything unknown). Only the Vocoder uses `frame`.
+    static TimeStretcher* create(int engine, int sampleRate, int channels, const VocoderFrame& frame = VocoderFrame());
+    virtual ~TimeStretcher() {}
+
+    virtual void setTempo(float tempo) = 0;
+    // SoundTouch.h setting ids; engines without such a setting ignore it.
+    virtual void setSetting(int /*settingId*/, int /*value*/) {}
+
+    virtual void putSamples(const float* samples, int numFrames) = 0;
+    // Returns the frames received (up to maxFrames).
+    virtual int receiveSamples(float* output, int maxFrames) = 0;
+    // Pads with silence so everything put so far comes out (end of material).
+    virtual void flush() = 0;
+    virtual void clear() = 0;
+
+    virtual int numSamples() = 0;            // output frames ready to receive
+    virtual int numUnprocessedSamples() = 0; // input frames not stretched yet
+
+    // Source frames the output runs ahead of the nominal time map (output
+    // frame i playing source frame i * tempo): once running, and counted from
+    // a cleared stretcher.
+    virtual double lead(float tempo) = 0;
+    virtual double startLead(float tempo) = 0;
+};
+
+#endif // TIME_STRETCHER_H
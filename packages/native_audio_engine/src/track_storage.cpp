@@ -0,0 +1,366 @@
+#include "track_storage.h"
+#include "block_codec.h"
+#include "mix_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Cache-line alignment keeps SIMD loads in the mix kernels from splitting lines.
+static const size_t kTrackAlignment = 64;
+
+static float* alignedAllocFloats(int64_t count) {
+    size_t bytes = static_cast<size_t>(count) * sizeof(float);
+#if defined(_WIN32)
+    return static_cast<float*>(_aligned_malloc(bytes, kTrackAlignment));
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, kTrackAlignment, bytes) != 0) return nullptr;
+    return static_cast<float*>(ptr);
+#endif
+}
+
+static void alignedFree(float* ptr) {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// --- ACTIVITY MAP ---
+
+void TrackStorage::resetActivity() {
+    int64_t numBlocks = (frames() + kActivityBlockFrames - 1) / kActivityBlockFrames;
+    _blockPeaks.assign(static_cast<size_t>(numBlocks), 0.0f);
+}
+
+void TrackStorage::scanActivity(const float* samples, int64_t startFrame, int64_t numFrames) {
+    int64_t firstBlock = startFrame / kActivityBlockFrames;
+    for (int64_t offset = 0; offset < numFrames; offset += kActivityBlockFrames) {
+        int64_t block = firstBlock + offset / kActivityBlockFrames;
+        if (block >= static_cast<int64_t>(_blockPeaks.size())) break;
+        int blockFrames = static_cast<int>(std::min<int64_t>(kActivityBlockFrames, numFrames - offset));
+        _blockPeaks[block] = mix_peak(samples + offset * _channels, blockFrames * _channels);
+    }
+}
+
+void TrackStorage::buildActivity() {
+    resetActivity();
+    if (_data) scanActivity(_data, 0, frames());
+}
+
+OwnedTrackStorage* OwnedTrackStorage::allocate(int64_t numSamples, int channels) {
+    if (numSamples <= 0 || channels <= 0) return nullptr;
+
+    float* data = alignedAllocFloats(numSamples);
+    if (!data) return nullptr;
+
+    OwnedTrackStorage* storage = new OwnedTrackStorage();
+    storage->_data = data;
+    storage->_numSamples = numSamples;
+    storage->_channels = channels;
+    return storage;
+}
+
+OwnedTrackStorage::~OwnedTrackStorage() {
+    alignedFree(_data);
+}
+
+AdoptedTrackStorage::AdoptedTrackStorage(float* data, int64_t numSamples, int channels, TrackReleaseFn release, void* context)
+    : _release(release), _context(context) {
+    _data = data;
+    _numSamples = numSamples;
+    _channels = channels;
+}
+
+AdoptedTrackStorage::~AdoptedTrackStorage() {
+    if (_release) {
+        _release(_context);
+    }
+}
+
+// --- MEMORY-MAPPED STORAGE ---
+
+struct WavLayout {
+    int formatTag = 0;
+    int channels = 0;
+    int sampleRate = 0;
+    int bitsPerSample = 0;
+    size_t dataOffset = 0;
+    size_t dataSize = 0;
+};
+
+static uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t readLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+// Walks the RIFF chunks for "fmt " and "data". Returns false if this is not a WAV file.
+static bool parseWavLayout(const uint8_t* bytes, size_t size, WavLayout& out) {
+    if (size < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = bytes + pos;
+        size_t chunkSize = readLE32(chunk + 4);
+        size_t body = pos + 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && body + 16 <= size) {
+            out.formatTag = readLE16(bytes + body);
+            out.channels = readLE16(bytes + body + 2);
+            out.sampleRate = static_cast<int>(readLE32(bytes + body + 4));
+            out.bitsPerSample = readLE16(bytes + body + 14);
+            // WAVE_FORMAT_EXTENSIBLE: the real format is the first 2 bytes of the SubFormat GUID
+            if (out.formatTag == 0xFFFE && chunkSize >= 40 && body + 26 <= size) {
+                out.formatTag = readLE16(bytes + body + 24);
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            out.dataOffset = body;
+            // Streaming writers leave 0 / 0xFFFFFFFF here, clamp to the file
+            out.dataSize = (chunkSize == 0 || body + chunkSize > size) ? size - body : chunkSize;
+            return out.channels > 0;
+        }
+
+        pos = body + chunkSize + (chunkSize & 1); // chunks are word aligned
+    }
+    return false;
+}
+
+MappedTrackStorage* MappedTrackStorage::open(const char* path, int channels) {
+    if (!path) return nullptr;
+
+    void* base = nullptr;
+    size_t size = 0;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "MappedTrackStorage: cannot open " << path << std::endl;
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "MappedTrackStorage: cannot open " << path << std::endl;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(st.st_size);
+    base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (base == MAP_FAILED) {
+        std::cerr << "MappedTrackStorage: mmap failed for " << path << std::endl;
+        return nullptr;
+    }
+    // Playback reads forward; let the kernel read ahead aggressively.
+    madvise(base, size, MADV_SEQUENTIAL);
+#endif
+
+    MappedTrackStorage* storage = new MappedTrackStorage();
+    storage->_mapBase = base;
+    storage->_mapSize = size;
+#if defined(_WIN32)
+    storage->_fileHandle = file;
+    storage->_mappingHandle = mapping;
+#endif
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(base);
+    WavLayout wav;
+    size_t dataOffset = 0;
+    size_t dataSize = size;
+
+    if (parseWavLayout(bytes, size, wav)) {
+        if (wav.formatTag != 3 || wav.bitsPerSample != 32) {
+            std::cerr << "MappedTrackStorage: " << path << " is not 32-bit float PCM" << std::endl;
+            delete storage;
+            return nullptr;
+        }
+        channels = wav.channels;
+        storage->_sampleRate = wav.sampleRate;
+        dataOffset = wav.dataOffset;
+        dataSize = wav.dataSize;
+    } else if (channels <= 0) {
+        std::cerr << "MappedTrackStorage: raw file " << path << " needs a channel count" << std::endl;
+        delete storage;
+        return nullptr;
+    }
+
+    storage->_data = reinterpret_cast<float*>(const_cast<uint8_t*>(bytes) + dataOffset);
+    storage->_channels = channels;
+    storage->_numSamples = static_cast<int64_t>(dataSize / sizeof(float)) / channels * channels;
+    if (storage->_numSamples <= 0) {
+        delete storage;
+        return nullptr;
+    }
+    return storage;
+}
+
+MappedTrackStorage::~MappedTrackStorage() {
+#if defined(_WIN32)
+    if (_mapBase) UnmapViewOfFile(_mapBase);
+    if (_mappingHandle) CloseHandle(static_cast<HANDLE>(_mappingHandle));
+    if (_fileHandle) CloseHandle(static_cast<HANDLE>(_fileHandle));
+#else
+    if (_mapBase) munmap(_mapBase, _mapSize);
+#endif
+}
+
+void MappedTrackStorage::prefetch(int64_t startFrame, int64_t numFrames) {
+#if defined(_WIN32)
+    // PrefetchVirtualMemory would need Windows 8 headers; sequential-scan on the
+    // file handle already gives us read-ahead on desktop.
+    (void)startFrame;
+    (void)numFrames;
+#else
+    int64_t frames = this->frames();
+    if (startFrame < 0) startFrame = 0;
+    if (startFrame >= frames || numFrames <= 0) return;
+    if (startFrame + numFrames > frames) numFrames = frames - startFrame;
+
+    static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(_data + startFrame * _channels);
+    uintptr_t end = reinterpret_cast<uintptr_t>(_data + (startFrame + numFrames) * _channels);
+    begin &= ~(pageSize - 1);
+
+    // WILLNEED only queues asynchronous read-ahead, it doesn't wait for I/O.
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+}
+
+// --- COMPRESSED STORAGE ---
+
+static inline int16_t quantizeInt16(float sample) {
+    float scaled = sample * 32768.0f;
+    if (scaled > 32767.0f) scaled = 32767.0f;
+    if (scaled < -32768.0f) scaled = -32768.0f;
+    return static_cast<int16_t>(lrintf(scaled));
+}
+
+CompressedTrackStorage* CompressedTrackStorage::encode(const float* data, int64_t numSamples, int channels, TrackCodec codec) {
+    if (!data || numSamples <= 0 || channels <= 0) return nullptr;
+    if (codec != kTrackCodecInt16 && codec != kTrackCodecLossless) return nullptr;
+
+    CompressedTrackStorage* storage = new CompressedTrackStorage();
+    storage->_codec = codec;
+    storage->_channels = channels;
+    storage->_numSamples = numSamples / channels * channels;
+
+    int64_t frames = storage->frames();
+    // A block below kSilentPeak quantizes to all zeros, so skipping it is exact
+    storage->resetActivity();
+    storage->scanActivity(data, 0, frames);
+
+    std::vector<int16_t> pcm(static_cast<size_t>(storage->_numSamples));
+    for (int64_t i = 0; i < storage->_numSamples; i++) {
+        pcm[i] = quantizeInt16(data[i]);
+    }
+
+    if (codec == kTrackCodecInt16) {
+        storage->_pcm16.swap(pcm);
+    } else {
+        int64_t numBlocks = (frames + kBlockFrames - 1) / kBlockFrames;
+        storage->_blockOffsets.reserve(numBlocks);
+        for (int64_t block = 0; block < numBlocks; block++) {
+            int64_t start = block * kBlockFrames;
+            int blockFrames = static_cast<int>(std::min<int64_t>(kBlockFrames, frames - start));
+            storage->_blockOffsets.push_back(storage->_stream.size());
+            block_codec_encode(pcm.data() + start * channels, blockFrames, channels, storage->_stream);
+        }
+        // The bit reader may look up to 8 bytes past the last block
+        storage->_stream.resize(storage->_stream.size() + 8, 0);
+        storage->_stream.shrink_to_fit();
+    }
+
+    for (CacheSlot& slot : storage->_cache) {
+        slot.pcm.resize(static_cast<size_t>(kBlockFrames) * channels);
+    }
+    return storage;
+}
+
+size_t CompressedTrackStorage::encodedBytes() const {
+    return _pcm16.size() * sizeof(int16_t) + _stream.size() + _blockOffsets.size() * sizeof(uint64_t);
+}
+
+void CompressedTrackStorage::_decodeBlock(int64_t block, float* out) {
+    int64_t start = block * kBlockFrames;
+    int blockFrames = static_cast<int>(std::min<int64_t>(kBlockFrames, frames() - start));
+
+    if (_codec == kTrackCodecInt16) {
+        const int16_t* in = _pcm16.data() + start * _channels;
+        int samples = blockFrames * _channels;
+        for (int i = 0; i < samples; i++) {
+            out[i] = in[i] * (1.0f / 32768.0f);
+        }
+    } else {
+        block_codec_decode(_stream.data() + _blockOffsets[block], blockFrames, _channels, out);
+    }
+}
+
+const float* CompressedTrackStorage::decodeAt(int64_t frame, int64_t& available) {
+    if (frame < 0 || frame >= frames()) {
+        available = 0;
+        return nullptr;
+    }
+
+    int64_t block = frame / kBlockFrames;
+    int64_t offset = frame - block * kBlockFrames;
+    available = std::min<int64_t>(kBlockFrames, frames() - block * kBlockFrames) - offset;
+
+    CacheSlot* victim = &_cache[0];
+    for (CacheSlot& slot : _cache) {
+        if (slot.block == block) {
+            slot.lastUse = ++_useCounter;
+            return slot.pcm.data() + offset * _channels;
+        }
+        if (slot.lastUse < victim->lastUse) victim = &slot;
+    }
+
+    _decodeBlock(block, victim->pcm.data());
+    victim->block = block;
+    victim->lastUse = ++_useCounter;
+    return victim->pcm.data() + offset * _channels;
+}
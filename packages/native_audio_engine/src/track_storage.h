@@ -0,0 +1,164 @@
+#ifndef TRACK_STORAGE_H
+#define TRACK_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Called exactly once when the mixer no longer needs an adopted buffer.
+typedef void (*TrackReleaseFn)(void* context);
+
+// In-memory sample formats for CompressedTrackStorage.
+enum TrackCodec {
+    kTrackCodecFloat32 = 0,  // plain float PCM (OwnedTrackStorage)
+    kTrackCodecInt16 = 1,    // 16-bit PCM, 2x smaller
+    kTrackCodecLossless = 2, // 16-bit PCM through block_codec, 3-5x smaller on quiet stems
+};
+
+// --- TRACK STORAGE ---
+// Backing memory of one LiveMixer track: interleaved float PCM.
+// The mixer only ever reads through data(), so it does not care who owns it.
+class TrackStorage {
+public:
+    virtual ~TrackStorage() = default;
+
+    const float* data() const { return _data; }
+    int64_t numSamples() const { return _numSamples; }
+    int channels() const { return _channels; }
+    int64_t frames() const { return _channels > 0 ? _numSamples / _channels : 0; }
+
+    // Storages backed by the page cache want read-ahead hints from the mixer.
+    virtual bool wantsPrefetch() const { return false; }
+    // Hint that frames [startFrame, startFrame + numFrames) will be read soon.
+    // Must not block; called from the audio thread.
+    virtual void prefetch(int64_t /*startFrame*/, int64_t /*numFrames*/) {}
+
+    // Storages without a flat float view (data() == nullptr) decode on demand.
+    // Returns interleaved floats starting at `frame` and sets `available` to the
+    // number of frames readable from there. Audio thread only; the pointer stays
+    // valid until the next call.
+    virtual const float* decodeAt(int64_t /*frame*/, int64_t& available) {
+        available = 0;
+        return nullptr;
+    }
+
+    // --- ACTIVITY MAP ---
+    // Peak |sample| (over all channels) of every kActivityBlockFrames block, so
+    // the mixer can skip a stem while it rests. Blocks below kSilentPeak (half a
+    // 16-bit LSB) are inaudible and skipped. Empty when unknown (memory-mapped
+    // files); such tracks are always mixed.
+    static constexpr int kActivityBlockFrames = 512;
+    static constexpr float kSilentPeak = 1.0f / 65536.0f;
+
+    bool hasActivity() const { return !_blockPeaks.empty(); }
+    const float* blockPeaks() const { return _blockPeaks.data(); }
+
+    // Sizes the map for frames(); every block starts out silent.
+    void resetActivity();
+    // Fills in the blocks covering [startFrame, startFrame + numFrames) from the
+    // interleaved `samples` of those frames. startFrame must be block aligned.
+    // Must happen before the frames are handed to the audio thread.
+    void scanActivity(const float* samples, int64_t startFrame, int64_t numFrames);
+    // resetActivity() + scanActivity() over the whole flat buffer.
+    void buildActivity();
+
+protected:
+    float* _data = nullptr;
+    int64_t _numSamples = 0;
+    int _channels = 0;
+    std::vector<float> _blockPeaks;
+};
+
+// Mixer-owned, 64-byte aligned buffer. Either copied into from the caller,
+// or handed out (writableData) so Dart can decode straight into it.
+class OwnedTrackStorage : public TrackStorage {
+public:
+    // Returns nullptr if the allocation fails.
+    static OwnedTrackStorage* allocate(int64_t numSamples, int channels);
+    ~OwnedTrackStorage() override;
+
+    float* writableData() { return _data; }
+
+private:
+    OwnedTrackStorage() = default;
+};
+
+// Caller-owned buffer adopted without a copy. `release(context)` runs when the
+// track is removed, replaced or the mixer is destroyed.
+class AdoptedTrackStorage : public TrackStorage {
+public:
+    AdoptedTrackStorage(float* data, int64_t numSamples, int channels, TrackReleaseFn release, void* context);
+    ~AdoptedTrackStorage() override;
+
+private:
+    TrackReleaseFn _release;
+    void* _context;
+};
+
+// Read-only memory map of a 32-bit float WAV or a headerless raw float file.
+// Residency is left to the OS page cache, so long exercises no longer have to
+// fit in RAM; the mixer issues read-ahead hints around the playhead and loop.
+class MappedTrackStorage : public TrackStorage {
+public:
+    // `channels` is only used for raw files (WAV headers carry their own).
+    // Returns nullptr (and logs) if the file can't be mapped or isn't float PCM.
+    static MappedTrackStorage* open(const char* path, int channels);
+    ~MappedTrackStorage() override;
+
+    bool wantsPrefetch() const override { return true; }
+    void prefetch(int64_t startFrame, int64_t numFrames) override;
+
+    // Rate from the WAV header, 0 for raw files.
+    int sampleRate() const { return _sampleRate; }
+
+private:
+    MappedTrackStorage() = default;
+
+    int _sampleRate = 0;
+
+    void* _mapBase = nullptr;
+    size_t _mapSize = 0;
+#if defined(_WIN32)
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#endif
+};
+
+// Track kept as int16 or lossless-coded blocks of kBlockFrames frames.
+// The mixer pulls audio through decodeAt(), which decodes only the block under
+// the playhead into a small LRU cache (enough for a loop wrap to stay warm).
+class CompressedTrackStorage : public TrackStorage {
+public:
+    static constexpr int kBlockFrames = 4096;
+
+    // Quantizes `data` to 16 bits and encodes it. Returns nullptr on bad input.
+    static CompressedTrackStorage* encode(const float* data, int64_t numSamples, int channels, TrackCodec codec);
+
+    const float* decodeAt(int64_t frame, int64_t& available) override;
+
+    // Resident size of the encoded samples, for logging / memory budgets.
+    size_t encodedBytes() const;
+
+private:
+    CompressedTrackStorage() = default;
+
+    struct CacheSlot {
+        int64_t block = -1;
+        uint32_t lastUse = 0;
+        std::vector<float> pcm;
+    };
+    static constexpr int kCacheSlots = 3;
+
+    void _decodeBlock(int64_t block, float* out);
+
+    TrackCodec _codec = kTrackCodecInt16;
+    std::vector<int16_t> _pcm16;         // kTrackCodecInt16
+    std::vector<uint8_t> _stream;        // kTrackCodecLossless, padded by 8 bytes
+    std::vector<uint64_t> _blockOffsets; // kTrackCodecLossless, byte offset per block
+
+    // Audio thread only
+    CacheSlot _cache[kCacheSlots];
+    uint32_t _useCounter = 0;
+};
+
+#endif // TRACK_STORAGE_H
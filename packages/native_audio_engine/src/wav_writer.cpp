@@ -0,0 +1,151 @@
+#include "wav_writer.h"
+
+#include <cmath>
+#include <cstring>
+
+static const int kFileBufferBytes = 1 << 20;
+static const int kWaveFormatPcm = 1;
+static const int kWaveFormatIeeeFloat = 3;
+// "RIFF" size WAVE, JUNK (room for ds64), fmt, data header
+static const int kDs64Bytes = 28;
+static const int kHeaderBytes = 12 + 8 + kDs64Bytes + 8 + 16 + 8;
+static const uint64_t kMaxRiffSize = 0xFFFFFFFFull;
+
+static uint8_t* put16(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    return p + 2;
+}
+
+static uint8_t* put32(uint8_t* p, uint32_t v) {
+    p = put16(p, v & 0xFFFF);
+    return put16(p, v >> 16);
+}
+
+static uint8_t* put64(uint8_t* p, uint64_t v) {
+    p = put32(p, static_cast<uint32_t>(v));
+    return put32(p, static_cast<uint32_t>(v >> 32));
+}
+
+static uint8_t* putTag(uint8_t* p, const char* tag) {
+    memcpy(p, tag, 4);
+    return p + 4;
+}
+
+static inline int32_t quantize(float sample, float scale, float max) {
+    float scaled = sample * scale;
+    if (scaled > max) scaled = max;
+    if (scaled < -scale) scaled = -scale;
+    return static_cast<int32_t>(lrintf(scaled));
+}
+
+WavWriter* WavWriter::open(const char* path, int sampleRate, int channels, WavSampleFormat format) {
+    if (!path || sampleRate <= 0 || channels <= 0) return nullptr;
+    FILE* file = fopen(path, "wb");
+    if (!file) return nullptr;
+    setvbuf(file, nullptr, _IOFBF, kFileBufferBytes);
+
+    WavWriter* writer = new WavWriter();
+    writer->_file = file;
+    writer->_sampleRate = sampleRate;
+    writer->_channels = channels;
+    writer->_format = format;
+    writer->_bytesPerSample = format == kWavFormatPcm16 ? 2 : format == kWavFormatPcm24 ? 3 : 4;
+    if (!writer->_writeHeader(false)) {
+        delete writer;
+        return nullptr;
+    }
+    return writer;
+}
+
+WavWriter::~WavWriter() {
+    if (_file) fclose(_file);
+}
+
+bool WavWriter::write(const float* frames, int64_t numFrames) {
+    if (!_file || _failed) return false;
+    size_t samples = static_cast<size_t>(numFrames) * _channels;
+    _bytes.resize(samples * _bytesPerSample);
+    uint8_t* p = _bytes.data();
+
+    switch (_format) {
+        case kWavFormatPcm16:
+            for (size_t i = 0; i < samples; i++) {
+                p = put16(p, static_cast<uint32_t>(quantize(frames[i], 32768.0f, 32767.0f)));
+            }
+            break;
+        case kWavFormatPcm24:
+            for (size_t i = 0; i < samples; i++) {
+                uint32_t v = static_cast<uint32_t>(quantize(frames[i], 8388608.0f, 8388607.0f));
+                p[0] = static_cast<uint8_t>(v);
+                p[1] = static_cast<uint8_t>(v >> 8);
+                p[2] = static_cast<uint8_t>(v >> 16);
+                p += 3;
+            }
+            break;
+        default:
+            for (size_t i = 0; i < samples; i++) {
+                uint32_t v;
+                memcpy(&v, &frames[i], 4);
+                p = put32(p, v);
+            }
+            break;
+    }
+
+    if (fwrite(_bytes.data(), 1, _bytes.size(), _file) != _bytes.size()) {
+        _failed = true;
+        return false;
+    }
+    _frames += numFrames;
+    return true;
+}
+
+bool WavWriter::finish() {
+    if (!_file) return false;
+    uint64_t dataBytes = static_cast<uint64_t>(_frames) * _channels * _bytesPerSample;
+    bool ok = !_failed && fflush(_file) == 0;
+    if (ok && (dataBytes & 1)) ok = fputc(0, _file) != EOF; // chunks are word aligned
+    ok = ok && fseek(_file, 0, SEEK_SET) == 0 && _writeHeader(kHeaderBytes - 8 + dataBytes > kMaxRiffSize);
+    ok = fclose(_file) == 0 && ok;
+    _file = nullptr;
+    return ok;
+}
+
+bool WavWriter::_writeHeader(bool rf64) {
+    uint64_t dataBytes = static_cast<uint64_t>(_frames) * _channels * _bytesPerSample;
+    uint64_t riffSize = kHeaderBytes - 8 + dataBytes + (dataBytes & 1);
+    int blockAlign = _channels * _bytesPerSample;
+
+    uint8_t header[kHeaderBytes];
+    uint8_t* p = putTag(header, rf64 ? "RF64" : "RIFF");
+    p = put32(p, rf64 ? static_cast<uint32_t>(kMaxRiffSize) : static_cast<uint32_t>(riffSize));
+    p = putTag(p, "WAVE");
+
+    // ds64 once the sizes no longer fit in 32 bits, otherwise a JUNK
+    // placeholder of the same size that readers skip
+    p = putTag(p, rf64 ? "ds64" : "JUNK");
+    p = put32(p, kDs64Bytes);
+    if (rf64) {
+        p = put64(p, riffSize);
+        p = put64(p, dataBytes);
+        p = put64(p, static_cast<uint64_t>(_frames));
+        p = put32(p, 0); // no table entries
+    } else {
+        memset(p, 0, kDs64Bytes);
+        p += kDs64Bytes;
+    }
+
+    p = putTag(p, "fmt ");
+    p = put32(p, 16);
+    p = put16(p, _format == kWavFormatFloat32 ? kWaveFormatIeeeFloat : kWaveFormatPcm);
+    p = put16(p, _channels);
+    p = put32(p, _sampleRate);
+    p = put32(p, _sampleRate * blockAlign);
+    p = put16(p, blockAlign);
+    p = put16(p, _bytesPerSample * 8);
+
+    p = putTag(p, "data");
+    put32(p, rf64 ? static_cast<uint32_t>(kMaxRiffSize) : static_cast<uint32_t>(dataBytes));
+
+    return fwrite(header, 1, kHeaderBytes, _file) == kHeaderBytes;
+}
@@ -0,0 +1,45 @@
+#ifndef WAV_WRITER_H
+#define WAV_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+enum WavSampleFormat {
+    kWavFormatPcm16 = 0,
+    kWavFormatPcm24 = 1,
+    kWavFormatFloat32 = 2,
+};
+
+// --- WAV WRITER ---
+// Streams interleaved float frames to a WAV file for offline export. The
+// header reserves room for an RF64 ds64 chunk (as a JUNK chunk), so a file
+// that grows past 4 GB is turned into RF64 by finish() without moving the
+// audio. Integer formats are rounded and clipped.
+class WavWriter {
+public:
+    // nullptr if the file can't be created.
+    static WavWriter* open(const char* path, int sampleRate, int channels, WavSampleFormat format);
+    ~WavWriter(); // closes; the header is only valid after finish()
+
+    bool write(const float* frames, int64_t numFrames);
+    // Patches the sizes into the header and closes the file.
+    bool finish();
+
+    int64_t framesWritten() const { return _frames; }
+
+private:
+    WavWriter() = default;
+    bool _writeHeader(bool rf64);
+
+    FILE* _file = nullptr;
+    int _sampleRate = 0;
+    int _channels = 0;
+    WavSampleFormat _format = kWavFormatPcm16;
+    int _bytesPerSample = 2;
+    int64_t _frames = 0;
+    bool _failed = false;
+    std::vector<uint8_t> _bytes; // conversion buffer
+};
+
+#endif // WAV_WRITER_H
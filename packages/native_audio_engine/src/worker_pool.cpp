@@ -0,0 +1,119 @@
+#include "worker_pool.h"
+
+static const int kMaxDefaultWorkers = 4;
+
+WorkerPool::WorkerPool(int numThreads) {
+    if (numThreads < 1) numThreads = 1;
+    _threads.reserve(numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        _threads.emplace_back(&WorkerPool::_run, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(job));
+    }
+    _wake.notify_one();
+}
+
+int WorkerPool::defaultThreadCount() {
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    int count = cores - 1;
+    if (count < 1) count = 1;
+    if (count > kMaxDefaultWorkers) count = kMaxDefaultWorkers;
+    return count;
+}
+
+void WorkerPool::_run() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) return; // stopping and drained
+            job = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        job();
+    }
+}
+
+BlockWorkers::BlockWorkers(int numThreads) {
+    if (numThreads < 1) numThreads = 1;
+    _threads.reserve(numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        _threads.emplace_back(&BlockWorkers::_run, this);
+    }
+}
+
+BlockWorkers::~BlockWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+void BlockWorkers::run(int count, JobFn fn, void* context) {
+    if (count <= 0) return;
+    _fn = fn;
+    _context = context;
+    _generation = (_generation + 1) & 0xffffffffu;
+    _pending.store(count, std::memory_order_relaxed);
+    _claim.store(_pack(_generation, count, 0), std::memory_order_release);
+    // Without the mutex a sleeper may miss this; the caller covers for it below.
+    _wake.notify_all();
+
+    while (_claimAndRun(_generation)) {}
+    while (_pending.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+// Claims one job of `generation` and runs it. False once none is left.
+bool BlockWorkers::_claimAndRun(uint64_t generation) {
+    uint64_t claim = _claim.load(std::memory_order_acquire);
+    for (;;) {
+        int count = static_cast<int>((claim >> 16) & 0xffff);
+        int index = static_cast<int>(claim & 0xffff);
+        if ((claim >> 32) != generation || index >= count) return false;
+        if (_claim.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            // Claimed an unfinished job, so the caller is still inside run()
+            // and _fn / _context belong to this generation.
+            _fn(_context, index);
+            _pending.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+void BlockWorkers::_run() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this, seen] {
+                return _stopping || (_claim.load(std::memory_order_acquire) >> 32) != seen;
+            });
+            if (_stopping) return;
+        }
+        seen = _claim.load(std::memory_order_acquire) >> 32;
+        while (_claimAndRun(seen)) {}
+    }
+}
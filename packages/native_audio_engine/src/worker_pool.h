@@ -0,0 +1,76 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- WORKER POOL ---
+// Small fixed-size thread pool for non-realtime engine work (decoding,
+// offline rendering, cache building). Never used from the audio callback.
+class WorkerPool {
+public:
+    explicit WorkerPool(int numThreads);
+    // Runs whatever is still queued, then joins. Long jobs should watch their
+    // own cancel flag so shutdown stays quick.
+    ~WorkerPool();
+
+    void submit(std::function<void()> job);
+    int size() const { return static_cast<int>(_threads.size()); }
+
+    // One thread per core minus one for the UI / audio threads, capped.
+    static int defaultThreadCount();
+
+private:
+    void _run();
+
+    std::vector<std::thread> _threads;
+    std::deque<std::function<void()>> _queue;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+};
+
+// --- BLOCK WORKERS ---
+// Splits one audio block into a few indexed jobs (e.g. one per stretch group)
+// and runs them in parallel. The calling thread claims jobs as well, so a
+// worker that is slow to wake costs parallelism, never the deadline: run()
+// takes no lock and allocates nothing, it only notifies the sleepers.
+class BlockWorkers {
+public:
+    typedef void (*JobFn)(void* context, int index);
+
+    explicit BlockWorkers(int numThreads);
+    ~BlockWorkers();
+
+    // Runs fn(context, 0 .. count - 1) and returns once every job has finished.
+    // One caller at a time.
+    void run(int count, JobFn fn, void* context);
+    int size() const { return static_cast<int>(_threads.size()); }
+
+private:
+    // Generation (high 32 bits), job count (16) and next unclaimed index (16)
+    // in one word, so a claim can never land on another block's jobs.
+    static uint64_t _pack(uint64_t generation, int count, int index) {
+        return (generation << 32) | (static_cast<uint64_t>(count) << 16) | static_cast<uint64_t>(index);
+    }
+    bool _claimAndRun(uint64_t generation);
+    void _run();
+
+    std::vector<std::thread> _threads;
+    std::atomic<uint64_t> _claim{0};
+    std::atomic<int> _pending{0};
+    JobFn _fn = nullptr;     // stable while jobs of the current generation are pending
+    void* _context = nullptr;
+    uint64_t _generation = 0; // caller side
+    std::mutex _mutex;        // sleepers only
+    std::condition_variable _wake;
+    bool _stopping = false;
+};
+
+#endif // WORKER_POOL_H
@@ -7,6 +7,8 @@
 // Include the Vocoder and KissFFT directly for a monolithic build
 #include "packages/native_audio_engine/src/Vocoder.cpp"
 #include "packages/native_audio_engine/src/kiss_fft.c"
+#include "packages/native_audio_engine/src/kiss_fftr.c"
+#include "packages/native_audio_engine/src/pv_kernels.cpp"
 
 using namespace std;
 